@@ -1,15 +1,20 @@
 #include "warren/json/parse/lexer.h"
 
 #include <cctype>    // isdigit, isspace, isxdigit, tolower
+#include <cstddef>   // size_t
+#include <cstdint>   // uint32_t
 #include <optional>  // nullopt, optional
+#include <string>
+#include <string_view>
 
 #include "warren/json/parse/token.h"
+#include "warren/json/parse/utf8.h"
 
 namespace warren {
 namespace json {
 
-Lexer::Lexer(std::string json)
-    : reader_(std::move(json)), curr_(TokenType::UNKNOWN, "") {}
+Lexer::Lexer(std::string json, const LexOptions& opts)
+    : opts_(opts), reader_(std::move(json)), curr_(TokenType::UNKNOWN, "") {}
 
 Lexer& Lexer::operator++() {
   curr_ = next_token();
@@ -110,25 +115,38 @@ Token Lexer::lex_string() {
 
   std::string res;
   while (!reader_.eof()) {
+    // Copy the run up to the next quote or escape in one go.
+    std::string_view rest = reader_.rest();
+    std::string_view run = rest.substr(0, rest.find_first_of("\"\\"));
+    if (opts_.validate_utf8) {
+      if (std::optional<size_t> invalid = find_invalid_utf8(run)) {
+        size_t pos = reader_.tell() + *invalid;
+        error_ = Error(TokenType::STRING, pos, "invalid UTF-8 sequence");
+        res += run.substr(0, *invalid);
+        return Token(TokenType::UNKNOWN, std::move(res));
+      }
+    }
+
+    res += run;
+    reader_.skip(run.size());
+    if (reader_.eof()) {
+      break;
+    }
+
     if (reader_.expect('"')) {
       return Token(TokenType::STRING, std::move(res));
     }
 
-    if (reader_.peek() == '\\') {
-      size_t start = reader_.tell();
-      std::optional<std::string> ctrl = lex_ctrl();
-      if (!ctrl) {
-        std::string token = res + reader_.substr(start, reader_.tell() - start);
-        error_ = Error(TokenType::STRING, start,
-                       "invalid control character: " + token);
-        return Token(TokenType::UNKNOWN, token);
-      }
-
-      res += *ctrl;
-      continue;
+    size_t escape = reader_.tell();
+    std::optional<std::string> ctrl = lex_ctrl();
+    if (!ctrl) {
+      std::string token = res + reader_.substr(escape, reader_.tell() - escape);
+      error_ = Error(TokenType::STRING, escape,
+                     "invalid control character: " + token);
+      return Token(TokenType::UNKNOWN, token);
     }
 
-    res += reader_.get();
+    res += *ctrl;
   }
 
   error_ = Error(TokenType::QUOTE, start, "unterminated string");
@@ -142,17 +160,31 @@ std::optional<std::string> Lexer::lex_ctrl() {
 
   switch (reader_.get()) {
     case 'u': {
-      std::string hex_digits;
-      hex_digits.reserve(4);
-      for (size_t i = 0; i < 4; i++) {
-        if (reader_.eof() || !isxdigit(reader_.peek())) {
+      // Escapes are decoded here rather than kept verbatim, so that an
+      // escaped backslash followed by "u" stays distinct from a \u escape.
+      std::optional<uint32_t> code_point = lex_hex4();
+      if (!code_point || (0xDC00 <= *code_point && *code_point <= 0xDFFF)) {
+        return std::nullopt;
+      }
+
+      // Section 3.8 Surrogates
+      // https://www.unicode.org/versions/Unicode15.0.0/ch03.pdf
+      // A high surrogate must be followed by an escaped low surrogate.
+      if (0xD800 <= *code_point && *code_point <= 0xDBFF) {
+        if (!reader_.expect('\\') || reader_.eof() || reader_.get() != 'u') {
           return std::nullopt;
         }
 
-        hex_digits += reader_.get();
+        std::optional<uint32_t> low = lex_hex4();
+        if (!low || *low < 0xDC00 || *low > 0xDFFF) {
+          return std::nullopt;
+        }
+
+        *code_point =
+            0x10000 + ((*code_point - 0xD800) << 10) + (*low - 0xDC00);
       }
 
-      return "\\u" + hex_digits;
+      return to_utf8(*code_point);
     }
     case '"':
       return "\"";
@@ -175,6 +207,20 @@ std::optional<std::string> Lexer::lex_ctrl() {
   }
 }
 
+std::optional<uint32_t> Lexer::lex_hex4() {
+  uint32_t res = 0;
+  for (size_t i = 0; i < 4; i++) {
+    if (reader_.eof() || !isxdigit(reader_.peek())) {
+      return std::nullopt;
+    }
+
+    char c = char(tolower(reader_.get()));
+    res = (res << 4) | uint32_t(c <= '9' ? c - '0' : c - 'a' + 10);
+  }
+
+  return res;
+}
+
 Token Lexer::lex_number() {
   Token integer = lex_integer();
   if (integer.type == TokenType::UNKNOWN) {
@@ -193,7 +239,9 @@ Token Lexer::lex_number() {
     return exponent;
   }
 
-  return Token(fraction.type, integer.value + fraction.value + exponent.value);
+  // An exponent makes a number a double even without a fraction.
+  TokenType type = exponent.value.empty() ? fraction.type : TokenType::DOUBLE;
+  return Token(type, integer.value + fraction.value + exponent.value);
 }
 
 Token Lexer::lex_integer() {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>  // uint32_t
 #include <optional>
 #include <string>
 
@@ -9,6 +10,12 @@
 namespace warren {
 namespace json {
 
+struct LexOptions {
+  // Reject strings that are not well-formed UTF-8, reporting the offset of
+  // the first invalid sequence. Escapes are checked either way.
+  bool validate_utf8 = false;
+};
+
 class Lexer {
  public:
   struct Error {
@@ -25,7 +32,7 @@ class Lexer {
     }
   };
 
-  explicit Lexer(std::string json);
+  explicit Lexer(std::string json, const LexOptions& opts = {});
 
   Lexer(Lexer&&) noexcept = default;
   Lexer& operator=(Lexer&&) noexcept = default;
@@ -50,6 +57,7 @@ class Lexer {
 
   Token lex_string();
   std::optional<std::string> lex_ctrl();
+  std::optional<uint32_t> lex_hex4();
 
   Token lex_number();
   Token lex_integer();
@@ -58,6 +66,7 @@ class Lexer {
 
   void strip_whitespace();
 
+  LexOptions opts_;
   Reader reader_;
   Token curr_;
   std::optional<Error> error_;
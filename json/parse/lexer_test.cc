@@ -140,9 +140,59 @@ TEST(LexerTest, LexStringUnicode) {
   ++lexer;
   EXPECT_TRUE(lexer);
   EXPECT_TRUE(lexer.ok());
+  EXPECT_THAT(*lexer, Eq(Token(TokenType::STRING, "A")));
+}
+
+TEST(LexerTest, LexStringUnicodeSequences) {
+  Lexer lexer(R"("\u00e9\u000a\ud83d\ude00" "\\u0041")");
+  ++lexer;
+  EXPECT_TRUE(lexer);
+  EXPECT_THAT(*lexer,
+              Eq(Token(TokenType::STRING, "\xc3\xa9\n\xf0\x9f\x98\x80")));
+
+  // An escaped backslash followed by "u" is not an escape.
+  ++lexer;
+  EXPECT_TRUE(lexer);
   EXPECT_THAT(*lexer, Eq(Token(TokenType::STRING, "\\u0041")));
 }
 
+TEST(LexerTest, LexInvalidUtf8) {
+  Lexer lexer("[\"ok\", \"caf\xc3\xa9 \xed\xa0\x80\"]",
+              {.validate_utf8 = true});
+  EXPECT_TRUE(++lexer);
+  EXPECT_TRUE(++lexer);
+  EXPECT_TRUE(++lexer);
+  ++lexer;
+  EXPECT_FALSE(lexer);
+  EXPECT_FALSE(lexer.ok());
+  EXPECT_THAT(lexer.error(),
+              Eq(Lexer::Error(TokenType::STRING,
+                              /*pos=*/14, "invalid UTF-8 sequence")));
+  EXPECT_THAT(*lexer, Eq(Token(TokenType::UNKNOWN, "caf\xc3\xa9 ")));
+}
+
+TEST(LexerTest, LexInvalidUtf8AfterEscape) {
+  Lexer lexer("\"\\n\\u00e9\xc3\"", {.validate_utf8 = true});
+  ++lexer;
+  EXPECT_FALSE(lexer.ok());
+  EXPECT_THAT(lexer.error().pos, Eq(9u));
+}
+
+TEST(LexerTest, LexUtf8) {
+  Lexer lexer("\"caf\xc3\xa9 \xf0\x9d\x84\x9e\\n\"",
+              {.validate_utf8 = true});
+  ++lexer;
+  EXPECT_TRUE(lexer);
+  EXPECT_THAT(*lexer,
+              Eq(Token(TokenType::STRING, "caf\xc3\xa9 \xf0\x9d\x84\x9e\n")));
+
+  // Without validation the bytes pass through unchecked.
+  Lexer unchecked("\"\xff\"");
+  ++unchecked;
+  EXPECT_TRUE(unchecked);
+  EXPECT_THAT(*unchecked, Eq(Token(TokenType::STRING, "\xff")));
+}
+
 TEST(LexerTest, LexInvalidNumberDash) {
   Lexer lexer("-");
   ++lexer;
@@ -193,6 +243,13 @@ TEST(LexerTest, LexInvalidNumberExponentSign) {
   EXPECT_THAT(*lexer, Eq(Token(TokenType::UNKNOWN, "1e+")));
 }
 
+TEST(LexerTest, LexNumberExponentIsDouble) {
+  Lexer lexer("2E-3");
+  ++lexer;
+  EXPECT_TRUE(lexer.ok());
+  EXPECT_THAT(*lexer, Eq(Token(TokenType::DOUBLE, "2E-3")));
+}
+
 TEST(LexerTest, LexNumberIntegral) {
   Lexer lexer("123");
   ++lexer;
@@ -1,9 +1,14 @@
 #include "warren/json/parse/parser.h"
 
-#include <cstddef>  // size_t
-#include <cstdint>  // int32_t, uint32_t
+#include <algorithm>  // min
+#include <charconv>   // from_chars
+#include <cstdint>    // int32_t, int64_t
 #include <map>
 #include <string>
+#include <string_view>
+#include <system_error>  // errc
+#include <utility>  // move
+#include <vector>
 
 #include "warren/json/parse/lexer.h"
 #include "warren/json/parse/token.h"
@@ -12,130 +17,191 @@
 
 namespace {
 
-uint32_t to_code_point(const char c1, const char c2, const char c3,
-                       const char c4) {
-  auto to_uint32 = [](const char c) -> uint32_t {
-    if (c >= '0' && c <= '9') {
-      return uint32_t(c - '0');
-    } else if (c >= 'A' && c <= 'F') {
-      return uint32_t(c - 'A' + 10);
-    } else if (c >= 'a' && c <= 'f') {
-      return uint32_t(c - 'a' + 10);
+// Whether a lexed number that std::from_chars found out of range for a
+// double is too close to zero rather than too large. Only the decimal
+// exponent of its leading significant digit matters.
+bool underflows(std::string_view number) {
+  size_t i = number.starts_with('-') ? 1 : 0;
+  int64_t magnitude = 0;
+  bool fraction = false;
+  bool significant = false;
+  for (; i < number.size() && number[i] != 'e' && number[i] != 'E'; i++) {
+    if (number[i] == '.') {
+      fraction = true;
+    } else if (!significant && number[i] == '0') {
+      magnitude -= fraction ? 1 : 0;
+    } else if (!significant) {
+      significant = true;
+      magnitude += fraction ? -1 : 0;
+    } else if (!fraction) {
+      magnitude++;
     }
+  }
 
-    return 0;
-  };
+  // The exponent saturates well past anything a double can hold.
+  constexpr int64_t kMaxExponent = int64_t{1} << 32;
+  int64_t exponent = 0;
+  bool negative = false;
+  if (i < number.size()) {
+    negative = number[++i] == '-';
+    if (number[i] == '-' || number[i] == '+') {
+      i++;
+    }
 
-  uint32_t code_point = 0;
-  code_point = (code_point << 4) | to_uint32(c1);
-  code_point = (code_point << 4) | to_uint32(c2);
-  code_point = (code_point << 4) | to_uint32(c3);
-  code_point = (code_point << 4) | to_uint32(c4);
+    for (; i < number.size(); i++) {
+      exponent = std::min(exponent * 10 + (number[i] - '0'), kMaxExponent);
+    }
+  }
 
-  return code_point;
+  return magnitude + (negative ? -exponent : exponent) < 0;
 }
 
-// https://www.ietf.org/rfc/rfc3629.txt
-void emit_utf8(uint32_t code_point, std::string& res) {
-  if (code_point > 0x10FFFF) {
-    throw warren::json::ParseException(
-        "Code point out of Unicode range (> 0x10FFFF)");
-  } else if (0xD800 <= code_point && code_point <= 0xDFFF) {
-    throw warren::json::ParseException(
-        "Code point in surrogate range [0xD800, 0xDFFF]");
-  }
+}  // namespace
 
-  if (code_point < 0x80) {
-    res += (char)(code_point);
-  } else if (code_point < 0x800) {
-    res += (char)(0xC0 | (code_point >> 6));
-    res += (char)(0x80 | (code_point & 0x3F));
-  } else if (code_point < 0x10000) {
-    res += (char)(0xE0 | (code_point >> 12));
-    res += (char)(0x80 | ((code_point >> 6) & 0x3F));
-    res += (char)(0x80 | (code_point & 0x3F));
-  } else {
-    res += (char)(0xF0 | (code_point >> 18));
-    res += (char)(0x80 | ((code_point >> 12) & 0x3F));
-    res += (char)(0x80 | ((code_point >> 6) & 0x3F));
-    res += (char)(0x80 | (code_point & 0x3F));
-  }
-}
+namespace warren {
+namespace json {
 
-std::string resolve_unicode_sequences(const std::string& s) {
-  std::string res;
-  res.reserve(s.length());
-  size_t i = 0;
-  size_t j = 0;
-  while (j < s.length()) {
-    if (s[j] == '\\' && s[j + 1] == 'u') {
-      res.append(s, i, j - i);
-      j += 6;
-
-      uint32_t code_point =
-          to_code_point(s[j - 4], s[j - 3], s[j - 2], s[j - 1]);
-
-      // Section 3.8 Surrogates
-      // https://www.unicode.org/versions/Unicode15.0.0/ch03.pdf
-      // 0xD800 <= high-surrogate code point <= 0xDBFF
-      uint32_t high_surrogate_cp = code_point;
-      if (0xD800 <= high_surrogate_cp && high_surrogate_cp <= 0xDBFF) {
-        j += 6;
-        if (j + 1 >= s.length() || s[j] != '\\' || s[j + 1] != 'u') {
-          throw warren::json::ParseException(
-              "Expected low surrogate after high surrogate: " +
-              s.substr(j - 6, 6));
-        }
+void TreeBuilder::scalar(Value value) { slot() = std::move(value); }
 
-        // 0xDC00 <= low-surrogate code point <= 0xDFFF
-        uint32_t low_surrogate_cp =
-            to_code_point(s[j - 4], s[j - 3], s[j - 2], s[j - 1]);
-        if (!(0xDC00 <= low_surrogate_cp && low_surrogate_cp <= 0xDFFF)) {
-          throw warren::json::ParseException(
-              "Invalid low surrogate (" + s.substr(j - 6, 6) +
-              ") after high surrogate: " + s.substr(j - 12, 6));
-        }
+void TreeBuilder::begin_array() { open(array_t()); }
 
-        code_point = 0x10000 + ((high_surrogate_cp - 0xD800) << 10) +
-                     (low_surrogate_cp - 0xDC00);
-      }
+void TreeBuilder::end_array() { open_.pop_back(); }
 
-      emit_utf8(code_point, res);
-      i = j;
-    }
+void TreeBuilder::begin_object() { open(object_t()); }
 
-    j++;
+void TreeBuilder::key(std::string key) { key_ = std::move(key); }
+
+void TreeBuilder::end_object() { open_.pop_back(); }
+
+Value TreeBuilder::release() { return std::move(root_); }
+
+// Containers only grow after their open children are closed, so the
+// pointers in `open_` stay valid.
+Value& TreeBuilder::slot() {
+  if (open_.empty()) {
+    return root_;
   }
 
-  if (i < s.length()) {
-    res.append(s, i, s.length() - i);
+  Value& parent = *open_.back();
+  if (parent.is_array()) {
+    return parent.emplace_back();
   }
 
-  return res;
+  object_t& members = parent;
+  return members.insert_or_assign(std::move(key_), Value()).first->second;
 }
 
-}  // namespace
-
-namespace warren {
-namespace json {
+void TreeBuilder::open(Value container) {
+  Value& value = slot();
+  value = std::move(container);
+  open_.push_back(&value);
+}
 
 Parser::Parser(Lexer lexer) : lexer_(std::move(lexer)) {}
 
+Parser::Parser(std::string json, const LexOptions& opts)
+    : lexer_(std::move(json), opts) {}
+
 Value Parser::parse() {
+  TreeBuilder builder;
+  parse(builder);
+
+  return builder.release();
+}
+
+void Parser::parse(ParseHandler& handler) {
   ++lexer_;
   if (!lexer_.ok()) {
     throw ParseException(to_string(lexer_.error()));
   }
 
-  Value json = parse_value();
-  if (!lexer_.eof()) {
-    throw ParseException("Unexpected token: " + to_string(*lexer_));
-  }
+  // The containers enclosing the current position, innermost last.
+  std::vector<TokenType> open;
+  while (true) {
+    switch (lexer_->type) {
+      case TokenType::ARRAY_START:
+      case TokenType::OBJECT_START: {
+        bool is_array = lexer_->type == TokenType::ARRAY_START;
+        if (is_array) {
+          handler.begin_array();
+        } else {
+          handler.begin_object();
+        }
+
+        ++lexer_;
+        if (!lexer_.ok()) {
+          throw ParseException(to_string(lexer_.error()));
+        }
+
+        TokenType end = is_array ? TokenType::ARRAY_END : TokenType::OBJECT_END;
+        if (lexer_->type != end) {
+          open.push_back(end);
+          if (!is_array) {
+            handler.key(parse_key());
+          }
+
+          continue;
+        }
+
+        ++lexer_;
+        if (is_array) {
+          handler.end_array();
+        } else {
+          handler.end_object();
+        }
+
+        break;
+      }
+      default:
+        handler.scalar(parse_scalar());
+        break;
+    }
+
+    // A value just ended: close the containers it completes, then step to
+    // the next element or member.
+    while (true) {
+      if (open.empty()) {
+        if (!lexer_.eof()) {
+          throw ParseException("Unexpected token: " + to_string(*lexer_));
+        }
+
+        return;
+      }
+
+      bool is_array = open.back() == TokenType::ARRAY_END;
+      if (!lexer_) {
+        throw ParseException(!lexer_.ok() ? to_string(lexer_.error())
+                             : is_array   ? "Unterminated array"
+                                          : "Unterminated object");
+      }
+
+      if (lexer_->type == open.back()) {
+        ++lexer_;
+        open.pop_back();
+        if (is_array) {
+          handler.end_array();
+        } else {
+          handler.end_object();
+        }
+
+        continue;
+      }
+
+      if (lexer_->type != TokenType::COMMA) {
+        throw ParseException("Unexpected token: " + to_string(*lexer_));
+      }
+
+      ++lexer_;
+      if (!is_array) {
+        handler.key(parse_key());
+      }
 
-  return json;
+      break;
+    }
+  }
 }
 
-Value Parser::parse_value() {
+Value Parser::parse_scalar() {
   switch (lexer_->type) {
     case TokenType::BOOLEAN:
       return parse_boolean();
@@ -146,15 +212,33 @@ Value Parser::parse_value() {
     case TokenType::DOUBLE:
     case TokenType::INTEGRAL:
       return parse_number();
-    case TokenType::ARRAY_START:
-      return parse_array();
-    case TokenType::OBJECT_START:
-      return parse_object();
     default:
-      throw ParseException("Unexpected token: " + to_string(*lexer_));
+      throw ParseException(lexer_.ok() ? "Unexpected token: " +
+                                             to_string(*lexer_)
+                                       : to_string(lexer_.error()));
   }
 }
 
+std::string Parser::parse_key() {
+  if (lexer_->type != TokenType::STRING) {
+    throw ParseException(lexer_.ok() ? "Unexpected token: " +
+                                           to_string(*lexer_)
+                                     : to_string(lexer_.error()));
+  }
+
+  std::string key = parse_string();
+  if (lexer_->type != TokenType::COLON) {
+    throw ParseException("Unexpected token: " + to_string(*lexer_));
+  }
+
+  ++lexer_;
+  if (!lexer_.ok()) {
+    throw ParseException(to_string(lexer_.error()));
+  }
+
+  return key;
+}
+
 nullptr_t Parser::parse_null() {
   ++lexer_;
 
@@ -169,98 +253,47 @@ bool Parser::parse_boolean() {
 }
 
 std::string Parser::parse_string() {
-  std::string value = resolve_unicode_sequences(lexer_->value);
+  std::string value = lexer_->value;
   ++lexer_;
 
   return value;
 }
 
 Value Parser::parse_number() {
-  Value value;
-  switch (lexer_->type) {
-    case TokenType::DOUBLE:
-      value = std::stod(lexer_->value);
-      break;
-    case TokenType::INTEGRAL:
-      value = std::stoi(lexer_->value);
-      break;
-    default:
-      __builtin_unreachable();
-  }
-
-  ++lexer_;
-
-  return value;
-}
-
-array_t Parser::parse_array() {
-  ++lexer_;
-  if (!lexer_.ok()) {
-    throw ParseException(to_string(lexer_.error()));
-  }
-
-  array_t value;
-  if (lexer_->type == TokenType::ARRAY_END) {
-    ++lexer_;
-    return value;
-  }
-
-  while (lexer_) {
-    value.push_back(parse_value());
-    if (lexer_->type == TokenType::ARRAY_END) {
+  const std::string& number = lexer_->value;
+  const char* first = number.data();
+  const char* last = number.data() + number.size();
+
+  if (lexer_->type == TokenType::INTEGRAL) {
+    int32_t i = 0;
+    std::from_chars_result result = std::from_chars(first, last, i);
+    if (result.ec == std::errc() && result.ptr == last) {
       ++lexer_;
-      return value;
+      return i;
     }
 
-    if (lexer_->type != TokenType::COMMA) {
-      throw ParseException("Unexpected token: " + to_string(*lexer_));
+    // Integers past int32 are kept as doubles, as the codecs do.
+    if (result.ec != std::errc::result_out_of_range) {
+      throw ParseException("Invalid number: " + number);
     }
-
-    ++lexer_;
   }
 
-  throw ParseException(lexer_.ok() ? "Unterminated array"
-                                   : to_string(lexer_.error()));
-}
-
-object_t Parser::parse_object() {
-  ++lexer_;
-  if (!lexer_.ok()) {
-    throw ParseException(to_string(lexer_.error()));
-  }
-
-  object_t value;
-  if (lexer_->type == TokenType::OBJECT_END) {
-    ++lexer_;
-    return value;
-  }
-
-  while (lexer_) {
-    std::string key = parse_string();
-    if (lexer_->type != TokenType::COLON) {
-      throw ParseException("Unexpected token: " + to_string(*lexer_));
+  double d = 0;
+  std::from_chars_result result = std::from_chars(first, last, d);
+  if (result.ec == std::errc::result_out_of_range) {
+    // Too small to represent rounds to zero; too large has no double.
+    if (!underflows(number)) {
+      throw ParseException("Number out of range: " + number);
     }
 
-    ++lexer_;
-    if (!lexer_.ok()) {
-      throw ParseException(to_string(lexer_.error()));
-    }
-
-    value[key] = parse_value();
-    if (lexer_->type == TokenType::OBJECT_END) {
-      ++lexer_;
-      return value;
-    }
-
-    if (lexer_->type != TokenType::COMMA) {
-      throw ParseException("Unexpected token: " + to_string(*lexer_));
-    }
-
-    ++lexer_;
+    d = number.starts_with('-') ? -0.0 : 0.0;
+  } else if (result.ec != std::errc() || result.ptr != last) {
+    throw ParseException("Invalid number: " + number);
   }
 
-  throw ParseException(lexer_.ok() ? "Unterminated object"
-                                   : to_string(lexer_.error()));
+  ++lexer_;
+
+  return d;
 }
 
 }  // namespace json
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <string>
+#include <vector>
 
 #include "warren/json/parse/lexer.h"
 #include "warren/json/value.h"
@@ -8,9 +10,53 @@
 namespace warren {
 namespace json {
 
+// Receives a document as it is parsed, in document order. Each object
+// member is a key() followed by the events of its value. Exceptions thrown
+// by a handler stop the parse.
+class ParseHandler {
+ public:
+  virtual ~ParseHandler() = default;
+
+  // null, boolean, number or string
+  virtual void scalar(Value value) = 0;
+  virtual void begin_array() = 0;
+  virtual void end_array() = 0;
+  virtual void begin_object() = 0;
+  virtual void key(std::string key) = 0;
+  virtual void end_object() = 0;
+};
+
+// Builds the Value tree for the events it receives; Parser::parse() without
+// a handler uses one. Later duplicate keys replace earlier ones.
+class TreeBuilder : public ParseHandler {
+ public:
+  void scalar(Value value) override;
+  void begin_array() override;
+  void end_array() override;
+  void begin_object() override;
+  void key(std::string key) override;
+  void end_object() override;
+
+  Value release();
+
+ protected:
+  // The innermost open container, from its begin event to its end event.
+  Value& innermost() noexcept { return *open_.back(); }
+
+ private:
+  Value& slot();
+  void open(Value container);
+
+  Value root_;
+  std::vector<Value*> open_;
+  std::string key_;
+};
+
 class Parser {
  public:
   explicit Parser(Lexer lexer);
+  // Lexes `json` with `opts`.
+  explicit Parser(std::string json, const LexOptions& opts = {});
 
   Parser(Parser&&) noexcept = default;
   Parser& operator=(Parser&&) noexcept = default;
@@ -20,15 +66,21 @@ class Parser {
 
   Value parse();
 
+  // Streams the document to `handler` without building a tree. Containers
+  // are tracked on an explicit stack, so nesting depth is bounded only by
+  // memory.
+  void parse(ParseHandler& handler);
+
  private:
-  Value parse_value();
+  Value parse_scalar();
+  std::string parse_key();
 
   nullptr_t parse_null();
   bool parse_boolean();
   std::string parse_string();
+  // Integers past int32 become doubles and doubles too small to represent
+  // become zero. Throws ParseException on a double too large to represent.
   Value parse_number();
-  array_t parse_array();
-  object_t parse_object();
 
  private:
   Lexer lexer_;
@@ -1,5 +1,9 @@
 #include "warren/json/parse/parser.h"
 
+#include <cmath>  // signbit
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "warren/json/parse/lexer.h"
@@ -9,9 +13,29 @@ namespace json {
 
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::Throws;
 
+class Recorder final : public ParseHandler {
+ public:
+  void scalar(Value value) override {
+    events.push_back(value.is_string() ? "s" : "v");
+  }
+
+  void begin_array() override { events.push_back("["); }
+
+  void end_array() override { events.push_back("]"); }
+
+  void begin_object() override { events.push_back("{"); }
+
+  void key(std::string key) override { events.push_back(key + ":"); }
+
+  void end_object() override { events.push_back("}"); }
+
+  std::vector<std::string> events;
+};
+
 TEST(ParserTest, UnexpectedTokenAfterParsing) {
   EXPECT_THAT([] { Parser(Lexer("{} x")).parse(); }, Throws<ParseException>());
 }
@@ -106,6 +130,76 @@ TEST(ParserTest, SimpleArray) {
               Eq(array_t{1, "two", 3.4, nullptr, true, object_t{}, array_t{}}));
 }
 
+TEST(ParserTest, ExponentWithoutFraction) {
+  EXPECT_THAT(Parser(Lexer("[1e3, 2E-3, 1E30]")).parse(),
+              Eq(array_t{1000.0, 0.002, 1e30}));
+}
+
+TEST(ParserTest, NumberOutOfRange) {
+  EXPECT_THAT([] { Parser(Lexer("1e400")).parse(); }, Throws<ParseException>());
+  EXPECT_THAT([] { Parser(Lexer("-1.5e309")).parse(); },
+              Throws<ParseException>());
+  EXPECT_THAT([] { Parser(Lexer(std::string(400, '9'))).parse(); },
+              Throws<ParseException>());
+  EXPECT_THAT(Parser(Lexer("[2147483647, -2147483648]")).parse(),
+              Eq(array_t{2147483647, int32_t(-2147483648)}));
+}
+
+TEST(ParserTest, NumberUnderflowsToZero) {
+  Value value = Parser(Lexer("[1e-400, -1e-400, 0.0e-999, 1e-99999999999999, "
+                             "0.00000000001e-320, 1e-300]"))
+                    .parse();
+  EXPECT_THAT(value, Eq(array_t{0.0, 0.0, 0.0, 0.0, 0.0, 1e-300}));
+  EXPECT_TRUE(value[0].is_double());
+  EXPECT_TRUE(std::signbit(double(value[1])));
+  EXPECT_THAT(Parser(Lexer("1000000000000e-330")).parse(), Eq(1e-318));
+}
+
+TEST(ParserTest, IntegerPastInt32IsDouble) {
+  Value value =
+      Parser(Lexer("[2147483648, -2147483649, 3000000000, 12345678901, "
+                   "100000000000000000000]"))
+          .parse();
+  EXPECT_THAT(value, Eq(array_t{2147483648.0, -2147483649.0, 3000000000.0,
+                                12345678901.0, 1e20}));
+  EXPECT_TRUE(value[0].is_double());
+}
+
+TEST(ParserTest, LexOptions) {
+  EXPECT_THAT(Parser("\"\xff\"").parse(), Eq("\xff"));
+  EXPECT_THAT([] { Parser("\"\xff\"", {.validate_utf8 = true}).parse(); },
+              Throws<ParseException>());
+}
+
+TEST(ParserTest, Handler) {
+  Recorder recorder;
+  Parser(Lexer(R"({"a": [1, "x", {}], "b": {"c": null}})")).parse(recorder);
+  EXPECT_THAT(recorder.events, ElementsAre("{", "a:", "[", "v", "s", "{", "}",
+                                           "]", "b:", "{", "c:", "v", "}",
+                                           "}"));
+}
+
+TEST(ParserTest, HandlerStopsAtError) {
+  Recorder recorder;
+  EXPECT_THAT([&] { Parser(Lexer("[1, 2 3]")).parse(recorder); },
+              Throws<ParseException>());
+  EXPECT_THAT(recorder.events, ElementsAre("[", "v", "v"));
+}
+
+TEST(ParserTest, DeepNesting) {
+  constexpr size_t kDepth = 100000;
+  Value value =
+      Parser(Lexer(std::string(kDepth, '[') + std::string(kDepth, ']')))
+          .parse();
+  for (size_t i = 1; i < kDepth; i++) {
+    ASSERT_THAT(value.size(), Eq(1u));
+    Value inner = std::move(value[0]);
+    value = std::move(inner);
+  }
+
+  EXPECT_THAT(value, Eq(array_t{}));
+}
+
 }  // namespace
 
 }  // namespace json
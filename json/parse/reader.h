@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace warren {
 namespace json {
@@ -21,6 +22,13 @@ class Reader {
 
   bool expect(char c) { return json_[pos_] == c && ++pos_; }
 
+  // The unread input, valid until the reader is moved or destroyed.
+  std::string_view rest() const {
+    return std::string_view(json_).substr(pos_);
+  }
+
+  void skip(size_t n) { pos_ += n; }
+
   std::string substr(size_t start,
                      std::optional<size_t> length = std::nullopt) const {
     if (length) {
@@ -0,0 +1,163 @@
+#include "warren/json/parse/utf8.h"
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint32_t, uint64_t
+#include <cstring>  // memcpy
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace {
+
+constexpr size_t kBlockSize = 16;
+
+// Compiles to one SSE2 or NEON register; compares yield all-ones lanes.
+typedef uint8_t Block __attribute__((vector_size(kBlockSize)));
+
+Block load(const uint8_t* p) {
+  Block block;
+  std::memcpy(&block, p, sizeof(block));
+  return block;
+}
+
+// The block at `pos` moved `k` bytes later, so lane i holds byte pos + i - k.
+// Bytes before the input read as ASCII.
+Block load_behind(const uint8_t* p, size_t pos, size_t k) {
+  if (pos >= k) {
+    return load(p + pos - k);
+  }
+
+  uint8_t padded[3 + kBlockSize] = {};
+  std::memcpy(padded + 3, p + pos, kBlockSize);
+  return load(padded + 3 + pos - k);
+}
+
+template <typename V>
+bool any(V lanes) {
+  uint64_t words[2];
+  std::memcpy(words, &lanes, sizeof(words));
+  return (words[0] | words[1]) != 0;
+}
+
+// Whether any lane of `cur` breaks a sequence, given the three bytes before
+// each lane. A lead byte fixes how many continuation bytes follow it, and the
+// few leads with a narrower range for their second byte are checked against
+// it directly.
+bool has_error(Block cur, Block prev1, Block prev2, Block prev3) {
+  auto bad_byte = (cur == 0xc0) | (cur == 0xc1) | (cur >= 0xf5);
+  auto needs_continuation = (prev1 >= 0xc0) | (prev2 >= 0xe0) | (prev3 >= 0xf0);
+  auto is_continuation = (cur & 0xc0) == 0x80;
+  auto out_of_range = ((prev1 == 0xe0) & (cur < 0xa0)) |  // overlong
+                      ((prev1 == 0xed) & (cur > 0x9f)) |  // surrogate
+                      ((prev1 == 0xf0) & (cur < 0x90)) |  // overlong
+                      ((prev1 == 0xf4) & (cur > 0x8f));   // > U+10FFFF
+  return any(bad_byte | (needs_continuation ^ is_continuation) | out_of_range);
+}
+
+// Start of the sequence that `pos` falls inside, or `pos` if a sequence
+// starts there.
+size_t sequence_start(const uint8_t* p, size_t pos) {
+  for (size_t k = 1; k <= 3 && k <= pos; k++) {
+    uint8_t b = p[pos - k];
+    if (b < 0x80) {
+      break;
+    } else if (b >= 0xc0) {
+      size_t length = b >= 0xf0 ? 4 : b >= 0xe0 ? 3 : 2;
+      return length > k ? pos - k : pos;
+    }
+  }
+
+  return pos;
+}
+
+std::optional<size_t> find_invalid_scalar(const uint8_t* p, size_t pos,
+                                          size_t size) {
+  while (pos < size) {
+    uint8_t b = p[pos];
+    if (b < 0x80) {
+      pos++;
+      continue;
+    }
+
+    size_t length;
+    uint8_t lo = 0x80;
+    uint8_t hi = 0xbf;
+    if (b >= 0xc2 && b <= 0xdf) {
+      length = 2;
+    } else if (b >= 0xe0 && b <= 0xef) {
+      length = 3;
+      lo = b == 0xe0 ? 0xa0 : lo;
+      hi = b == 0xed ? 0x9f : hi;
+    } else if (b >= 0xf0 && b <= 0xf4) {
+      length = 4;
+      lo = b == 0xf0 ? 0x90 : lo;
+      hi = b == 0xf4 ? 0x8f : hi;
+    } else {
+      return pos;
+    }
+
+    if (size - pos < length || p[pos + 1] < lo || p[pos + 1] > hi) {
+      return pos;
+    }
+
+    for (size_t i = 2; i < length; i++) {
+      if ((p[pos + i] & 0xc0) != 0x80) {
+        return pos;
+      }
+    }
+
+    pos += length;
+  }
+
+  return std::nullopt;
+}
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+std::optional<size_t> find_invalid_utf8(std::string_view s) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(s.data());
+  size_t pos = 0;
+  for (; s.size() - pos >= kBlockSize; pos += kBlockSize) {
+    Block cur = load(p + pos);
+    if (!any(cur & 0x80) && sequence_start(p, pos) == pos) {
+      continue;
+    }
+
+    if (has_error(cur, load_behind(p, pos, 1), load_behind(p, pos, 2),
+                  load_behind(p, pos, 3))) {
+      // Everything before this block checked out, so decoding from the
+      // sequence straddling into it finds the error within the block.
+      return find_invalid_scalar(p, sequence_start(p, pos), s.size());
+    }
+  }
+
+  return find_invalid_scalar(p, sequence_start(p, pos), s.size());
+}
+
+// https://www.ietf.org/rfc/rfc3629.txt
+std::string to_utf8(uint32_t code_point) {
+  std::string res;
+  if (code_point < 0x80) {
+    res += char(code_point);
+  } else if (code_point < 0x800) {
+    res += char(0xC0 | (code_point >> 6));
+    res += char(0x80 | (code_point & 0x3F));
+  } else if (code_point < 0x10000) {
+    res += char(0xE0 | (code_point >> 12));
+    res += char(0x80 | ((code_point >> 6) & 0x3F));
+    res += char(0x80 | (code_point & 0x3F));
+  } else {
+    res += char(0xF0 | (code_point >> 18));
+    res += char(0x80 | ((code_point >> 12) & 0x3F));
+    res += char(0x80 | ((code_point >> 6) & 0x3F));
+    res += char(0x80 | (code_point & 0x3F));
+  }
+
+  return res;
+}
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint32_t
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace warren {
+namespace json {
+
+// Returns the offset of the first byte of the first sequence in `s` that is
+// not well-formed UTF-8 (RFC 3629): overlong forms, surrogates, code points
+// past U+10FFFF, stray continuation bytes and sequences cut short all count.
+// Returns nullopt if `s` is valid.
+//
+// Input is checked 16 bytes at a time with vector compares, skipping runs of
+// ASCII outright; bytes are only decoded one by one to pin down the offset of
+// an error and in the final partial block.
+std::optional<size_t> find_invalid_utf8(std::string_view s);
+
+// Encodes `code_point` as UTF-8 (RFC 3629). Callers reject surrogates and
+// code points past U+10FFFF.
+std::string to_utf8(uint32_t code_point);
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,82 @@
+#include "warren/json/parse/utf8.h"
+
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::Eq;
+using ::testing::Optional;
+
+TEST(Utf8Test, Valid) {
+  EXPECT_THAT(find_invalid_utf8(""), Eq(std::nullopt));
+  EXPECT_THAT(find_invalid_utf8(std::string(100, 'a')), Eq(std::nullopt));
+
+  // Sequences of every length, straddling each block boundary in turn.
+  const std::string text = "héllo € \U0001d11e ퟿ \U0010ffff";
+  for (size_t offset = 0; offset < 40; offset++) {
+    EXPECT_THAT(find_invalid_utf8(std::string(offset, ' ') + text + text),
+                Eq(std::nullopt))
+        << offset;
+  }
+}
+
+TEST(Utf8Test, Invalid) {
+  struct Case {
+    const char* bytes;
+    size_t error;
+  };
+
+  const Case kCases[] = {
+      {"\x80", 0},              // stray continuation
+      {"\xbf", 0},              // stray continuation
+      {"\xc0\xaf", 0},          // overlong
+      {"\xc1\xbf", 0},          // overlong
+      {"\xe0\x9f\xbf", 0},      // overlong
+      {"\xed\xa0\x80", 0},      // surrogate
+      {"\xf0\x8f\xbf\xbf", 0},  // overlong
+      {"\xf4\x90\x80\x80", 0},  // past U+10FFFF
+      {"\xf5\x80\x80\x80", 0},  // past U+10FFFF
+      {"\xff", 0},              // never valid
+      {"\xc3", 0},              // cut short
+      {"\xe2\x82", 0},          // cut short
+      {"\xf0\x9d\x84", 0},      // cut short
+      {"\xe2\x82\xac\xac", 3},  // one continuation too many
+  };
+
+  // Each case at every offset around the first two block boundaries.
+  for (const Case& c : kCases) {
+    for (size_t offset = 0; offset < 40; offset++) {
+      EXPECT_THAT(
+          find_invalid_utf8(std::string(offset, 'a') + c.bytes + "bcd"),
+          Optional(offset + c.error))
+          << offset << " " << c.bytes;
+    }
+  }
+}
+
+TEST(Utf8Test, CutShortAtEnd) {
+  for (size_t offset = 0; offset < 40; offset++) {
+    EXPECT_THAT(find_invalid_utf8(std::string(offset, 'a') + "\xe2\x82"),
+                Optional(offset))
+        << offset;
+  }
+}
+
+TEST(Utf8Test, ReportsFirstError) {
+  EXPECT_THAT(find_invalid_utf8("é\x80\xff"), Optional(2u));
+  EXPECT_THAT(find_invalid_utf8(std::string(20, 'a') + "\xff" +
+                                std::string(20, 'b') + "\x80"),
+              Optional(20u));
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
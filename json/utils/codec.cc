@@ -0,0 +1,705 @@
+#include "warren/json/utils/codec.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>  // size_t
+#include <cstdint>  // int32_t, int64_t, uint8_t, uint16_t, uint32_t, uint64_t
+#include <deque>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>  // move
+#include <vector>
+
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/value.h"
+
+namespace {
+
+using warren::json::array_t;
+using warren::json::object_t;
+using warren::json::ParseException;
+using warren::json::Value;
+using warren::json::WriterException;
+
+void put_be(std::string& out, uint64_t n, size_t bytes) {
+  for (size_t i = bytes; i-- > 0;) {
+    out += static_cast<char>((n >> (8 * i)) & 0xff);
+  }
+}
+
+// Integers that fit keep the INTEGRAL type; the rest become doubles.
+Value integer(int64_t n) {
+  if (n >= std::numeric_limits<int32_t>::min() &&
+      n <= std::numeric_limits<int32_t>::max()) {
+    return static_cast<int32_t>(n);
+  }
+
+  return static_cast<double>(n);
+}
+
+Value unsigned_integer(uint64_t n) {
+  if (n <= uint64_t(std::numeric_limits<int32_t>::max())) {
+    return static_cast<int32_t>(n);
+  }
+
+  return static_cast<double>(n);
+}
+
+bool fits_float(double d) {
+  return std::fabs(d) <= std::numeric_limits<float>::max() &&
+         static_cast<double>(static_cast<float>(d)) == d;
+}
+
+// The IEEE 754 half float holding exactly `d`, if there is one.
+std::optional<uint16_t> to_half(double d) {
+  if (std::isnan(d)) {
+    return 0x7e00;
+  }
+
+  uint16_t sign = std::signbit(d) ? 0x8000 : 0;
+  double a = std::fabs(d);
+  if (a == 0) {
+    return sign;
+  } else if (std::isinf(a)) {
+    return static_cast<uint16_t>(sign | 0x7c00);
+  }
+
+  int exp;
+  std::frexp(a, &exp);
+  exp--;
+  if (exp > 15 || exp < -24) {
+    return std::nullopt;
+  }
+
+  // Normal halves hold 1.m * 2^exp with a 10-bit m, subnormals m * 2^-24.
+  double m =
+      exp >= -14 ? (std::ldexp(a, -exp) - 1) * 1024 : std::ldexp(a, 24);
+  if (m != std::floor(m)) {
+    return std::nullopt;
+  }
+
+  uint16_t bits = exp >= -14 ? static_cast<uint16_t>((exp + 15) << 10) : 0;
+  return static_cast<uint16_t>(sign | bits | static_cast<uint16_t>(m));
+}
+
+// RFC 8949 Appendix D.
+double from_half(uint16_t h) {
+  int exp = (h >> 10) & 0x1f;
+  int mant = h & 0x3ff;
+  double d;
+  if (exp == 0) {
+    d = std::ldexp(mant, -24);
+  } else if (exp != 31) {
+    d = std::ldexp(mant + 1024, exp - 25);
+  } else {
+    d = mant == 0 ? std::numeric_limits<double>::infinity()
+                  : std::numeric_limits<double>::quiet_NaN();
+  }
+
+  return h & 0x8000 ? -d : d;
+}
+
+// Unpadded base64url, RFC 4648 section 5.
+std::string base64url(std::string_view bytes) {
+  static constexpr char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+  std::string out;
+  out.reserve((bytes.size() + 2) / 3 * 4);
+  size_t i = 0;
+  auto at = [&bytes](size_t k) -> uint32_t {
+    return k < bytes.size() ? static_cast<uint8_t>(bytes[k]) : 0;
+  };
+  for (; i < bytes.size(); i += 3) {
+    uint32_t n = at(i) << 16 | at(i + 1) << 8 | at(i + 2);
+    size_t chars = std::min<size_t>(bytes.size() - i, 3) + 1;
+    for (size_t k = 0; k < chars; k++) {
+      out += kAlphabet[(n >> (18 - 6 * k)) & 0x3f];
+    }
+  }
+
+  return out;
+}
+
+// Walks `root` in document order, handing each node to `encoder`. Object
+// members are preceded by their key as a string.
+template <typename Encoder>
+void encode(const Value& root, Encoder& encoder) {
+  struct Frame {
+    Value::const_iterator it;
+    Value::const_iterator end;
+    bool is_object;
+  };
+
+  std::vector<Frame> stack;
+  std::deque<Value> expanded;
+  const Value* curr = &root;
+  while (true) {
+    if (curr->is_raw()) {
+      expanded.push_back(warren::json::parse(curr->raw()));
+      curr = &expanded.back();
+    }
+
+    if (curr->is_array() || curr->is_object()) {
+      if (curr->is_array()) {
+        encoder.array(curr->size());
+      } else {
+        encoder.object(curr->size());
+      }
+
+      stack.push_back({curr->begin(), curr->end(), curr->is_object()});
+    } else if (curr->is_null()) {
+      encoder.null();
+    } else if (curr->is_boolean()) {
+      encoder.boolean(bool(*curr));
+    } else if (curr->is_integral()) {
+      encoder.integer(int32_t(*curr));
+    } else if (curr->is_double()) {
+      encoder.number(double(*curr));
+    } else {
+      encoder.string(static_cast<const std::string&>(*curr));
+    }
+
+    while (!stack.empty() && stack.back().it == stack.back().end) {
+      stack.pop_back();
+    }
+
+    if (stack.empty()) {
+      return;
+    }
+
+    Frame& top = stack.back();
+    if (top.is_object) {
+      encoder.string(top.it.key());
+    }
+
+    curr = &*top.it++;
+  }
+}
+
+class CborEncoder {
+ public:
+  explicit CborEncoder(std::string& out) : out_(out) {}
+
+  void null() { out_ += '\xf6'; }
+
+  void boolean(bool b) { out_ += b ? '\xf5' : '\xf4'; }
+
+  void integer(int64_t n) {
+    if (n >= 0) {
+      head(0, static_cast<uint64_t>(n));
+    } else {
+      head(1, static_cast<uint64_t>(-1 - n));
+    }
+  }
+
+  void number(double d) {
+    if (std::optional<uint16_t> half = to_half(d)) {
+      out_ += '\xf9';
+      put_be(out_, *half, 2);
+    } else if (fits_float(d)) {
+      out_ += '\xfa';
+      put_be(out_, std::bit_cast<uint32_t>(static_cast<float>(d)), 4);
+    } else {
+      out_ += '\xfb';
+      put_be(out_, std::bit_cast<uint64_t>(d), 8);
+    }
+  }
+
+  void string(std::string_view s) {
+    head(3, s.size());
+    out_ += s;
+  }
+
+  void array(size_t size) { head(4, size); }
+
+  void object(size_t size) { head(5, size); }
+
+ private:
+  // Major type plus the shortest argument encoding, RFC 8949 4.2.1.
+  void head(uint8_t major, uint64_t n) {
+    char type = static_cast<char>(major << 5);
+    if (n < 24) {
+      out_ += static_cast<char>(type | static_cast<char>(n));
+    } else if (n <= 0xff) {
+      out_ += static_cast<char>(type | 24);
+      put_be(out_, n, 1);
+    } else if (n <= 0xffff) {
+      out_ += static_cast<char>(type | 25);
+      put_be(out_, n, 2);
+    } else if (n <= 0xffffffff) {
+      out_ += static_cast<char>(type | 26);
+      put_be(out_, n, 4);
+    } else {
+      out_ += static_cast<char>(type | 27);
+      put_be(out_, n, 8);
+    }
+  }
+
+  std::string& out_;
+};
+
+class MsgpackEncoder {
+ public:
+  explicit MsgpackEncoder(std::string& out) : out_(out) {}
+
+  void null() { out_ += '\xc0'; }
+
+  void boolean(bool b) { out_ += b ? '\xc3' : '\xc2'; }
+
+  void integer(int64_t n) {
+    if (n >= -32 && n <= 0x7f) {
+      out_ += static_cast<char>(n);
+    } else if (n > 0) {
+      sized('\xcc', static_cast<uint64_t>(n));
+    } else if (n >= std::numeric_limits<int8_t>::min()) {
+      out_ += '\xd0';
+      put_be(out_, static_cast<uint8_t>(n), 1);
+    } else if (n >= std::numeric_limits<int16_t>::min()) {
+      out_ += '\xd1';
+      put_be(out_, static_cast<uint16_t>(n), 2);
+    } else if (n >= std::numeric_limits<int32_t>::min()) {
+      out_ += '\xd2';
+      put_be(out_, static_cast<uint32_t>(n), 4);
+    } else {
+      out_ += '\xd3';
+      put_be(out_, static_cast<uint64_t>(n), 8);
+    }
+  }
+
+  void number(double d) {
+    if (std::isnan(d) || fits_float(d)) {
+      out_ += '\xca';
+      put_be(out_, std::bit_cast<uint32_t>(static_cast<float>(d)), 4);
+    } else {
+      out_ += '\xcb';
+      put_be(out_, std::bit_cast<uint64_t>(d), 8);
+    }
+  }
+
+  void string(std::string_view s) {
+    if (s.size() < 32) {
+      out_ += static_cast<char>(0xa0 | s.size());
+    } else if (s.size() <= 0xff) {
+      out_ += '\xd9';
+      put_be(out_, s.size(), 1);
+    } else {
+      container('\xda', s.size(), "string");
+    }
+
+    out_ += s;
+  }
+
+  void array(size_t size) {
+    if (size < 16) {
+      out_ += static_cast<char>(0x90 | size);
+    } else {
+      container('\xdc', size, "array");
+    }
+  }
+
+  void object(size_t size) {
+    if (size < 16) {
+      out_ += static_cast<char>(0x80 | size);
+    } else {
+      container('\xde', size, "object");
+    }
+  }
+
+ private:
+  // uint8 through uint64 start at `first` and go up by one per size class.
+  void sized(char first, uint64_t n) {
+    size_t bytes = 1;
+    while (bytes < 8 && n >> (8 * bytes) != 0) {
+      bytes *= 2;
+    }
+
+    out_ += static_cast<char>(first + std::countr_zero(bytes));
+    put_be(out_, n, bytes);
+  }
+
+  // The 16-bit length form is `first`, the 32-bit one `first + 1`.
+  void container(char first, size_t size, const char* what) {
+    if (size <= 0xffff) {
+      out_ += first;
+      put_be(out_, size, 2);
+    } else if (size <= 0xffffffff) {
+      out_ += static_cast<char>(first + 1);
+      put_be(out_, size, 4);
+    } else {
+      throw WriterException(std::string(what) + " too large for MessagePack");
+    }
+  }
+
+  std::string& out_;
+};
+
+// One decoded item: a scalar, the head of a container or a CBOR break.
+struct Item {
+  enum class Kind { SCALAR, ARRAY, OBJECT, BREAK };
+
+  Value value = {};
+  Kind kind = Kind::SCALAR;
+  size_t size = 0;
+  bool indefinite = false;
+};
+
+// Byte cursor shared by both decoders.
+class Input {
+ public:
+  Input(std::string_view data, const char* format)
+      : data_(data), format_(format) {}
+
+  size_t remaining() const noexcept { return data_.size() - pos_; }
+
+  bool done() const noexcept { return pos_ == data_.size(); }
+
+  uint8_t peek() const {
+    require(1);
+    return static_cast<uint8_t>(data_[pos_]);
+  }
+
+  uint8_t get() {
+    uint8_t b = peek();
+    pos_++;
+    return b;
+  }
+
+  uint64_t get_be(size_t bytes) {
+    require(bytes);
+    uint64_t n = 0;
+    for (size_t i = 0; i < bytes; i++) {
+      n = n << 8 | static_cast<uint8_t>(data_[pos_++]);
+    }
+
+    return n;
+  }
+
+  std::string_view take(uint64_t n) {
+    require(n);
+    std::string_view res = data_.substr(pos_, n);
+    pos_ += n;
+    return res;
+  }
+
+  // A container of `size` elements needs at least `size` more bytes, which
+  // bounds what a corrupt length can make us reserve.
+  size_t container_size(uint64_t size, uint64_t bytes_per_element) {
+    if (size > remaining() / bytes_per_element) {
+      fail("truncated input");
+    }
+
+    return static_cast<size_t>(size);
+  }
+
+  [[noreturn]] void fail(const std::string& what) const {
+    throw ParseException(std::string(format_) + ": " + what + " at byte " +
+                         std::to_string(pos_));
+  }
+
+ private:
+  void require(uint64_t n) const {
+    if (n > remaining()) {
+      fail("truncated input");
+    }
+  }
+
+  std::string_view data_;
+  size_t pos_ = 0;
+  const char* format_;
+};
+
+class CborDecoder {
+ public:
+  explicit CborDecoder(std::string_view data) : in_(data, "CBOR") {}
+
+  Input& input() { return in_; }
+
+  Item next() {
+    uint8_t head = in_.get();
+    // Tags only annotate the item that follows.
+    while (head >> 5 == 6) {
+      argument(head & 0x1f);
+      head = in_.get();
+    }
+
+    uint8_t info = head & 0x1f;
+    switch (head >> 5) {
+      case 0:
+        return {.value = unsigned_integer(argument(info))};
+      case 1: {
+        uint64_t n = argument(info);
+        if (n <= uint64_t(std::numeric_limits<int64_t>::max())) {
+          return {.value = integer(-1 - static_cast<int64_t>(n))};
+        }
+
+        return {.value = -1.0 - static_cast<double>(n)};
+      }
+      case 2:
+        return {.value = base64url(string(head))};
+      case 3:
+        return {.value = string(head)};
+      case 4:
+        if (info == 31) {
+          return {.kind = Item::Kind::ARRAY, .indefinite = true};
+        }
+
+        return {.kind = Item::Kind::ARRAY,
+                .size = in_.container_size(argument(info), 1)};
+      case 5:
+        if (info == 31) {
+          return {.kind = Item::Kind::OBJECT, .indefinite = true};
+        }
+
+        return {.kind = Item::Kind::OBJECT,
+                .size = in_.container_size(argument(info), 2)};
+      default:
+        return simple(info);
+    }
+  }
+
+  // Consumes the break ending an indefinite-length container, if next.
+  bool end_of_indefinite() {
+    if (in_.peek() == 0xff) {
+      in_.get();
+      return true;
+    }
+
+    return false;
+  }
+
+ private:
+  uint64_t argument(uint8_t info) {
+    if (info < 24) {
+      return info;
+    } else if (info <= 27) {
+      return in_.get_be(size_t(1) << (info - 24));
+    }
+
+    in_.fail("invalid additional information " + std::to_string(info));
+  }
+
+  // Byte or text string, concatenating the chunks of an indefinite one.
+  std::string string(uint8_t head) {
+    if ((head & 0x1f) != 31) {
+      return std::string(in_.take(argument(head & 0x1f)));
+    }
+
+    std::string res;
+    while (!end_of_indefinite()) {
+      uint8_t chunk = in_.get();
+      if ((chunk & 0xe0) != (head & 0xe0) || (chunk & 0x1f) == 31) {
+        in_.fail("invalid chunk in indefinite-length string");
+      }
+
+      res += in_.take(argument(chunk & 0x1f));
+    }
+
+    return res;
+  }
+
+  Item simple(uint8_t info) {
+    switch (info) {
+      case 20:
+        return {.value = false};
+      case 21:
+        return {.value = true};
+      case 22:
+      case 23:
+        return {.value = nullptr};
+      case 25:
+        return {.value = from_half(static_cast<uint16_t>(in_.get_be(2)))};
+      case 26:
+        return {.value = static_cast<double>(std::bit_cast<float>(
+                    static_cast<uint32_t>(in_.get_be(4))))};
+      case 27:
+        return {.value = std::bit_cast<double>(in_.get_be(8))};
+      case 31:
+        return {.kind = Item::Kind::BREAK};
+      default:
+        in_.fail("unsupported simple value " + std::to_string(info));
+    }
+  }
+
+  Input in_;
+};
+
+class MsgpackDecoder {
+ public:
+  explicit MsgpackDecoder(std::string_view data) : in_(data, "MessagePack") {}
+
+  Input& input() { return in_; }
+
+  Item next() {
+    uint8_t b = in_.get();
+    if (b <= 0x7f) {
+      return {.value = static_cast<int32_t>(b)};
+    } else if (b >= 0xe0) {
+      return {.value = static_cast<int32_t>(static_cast<int8_t>(b))};
+    } else if (b <= 0x8f) {
+      return object(b & 0x0f);
+    } else if (b <= 0x9f) {
+      return array(b & 0x0f);
+    } else if (b <= 0xbf) {
+      return {.value = std::string(in_.take(b & 0x1f))};
+    }
+
+    switch (b) {
+      case 0xc0:
+        return {.value = nullptr};
+      case 0xc2:
+        return {.value = false};
+      case 0xc3:
+        return {.value = true};
+      case 0xc4:
+      case 0xc5:
+      case 0xc6:
+        return {.value = base64url(
+                    in_.take(in_.get_be(size_t(1) << (b - 0xc4))))};
+      case 0xca:
+        return {.value = static_cast<double>(std::bit_cast<float>(
+                    static_cast<uint32_t>(in_.get_be(4))))};
+      case 0xcb:
+        return {.value = std::bit_cast<double>(in_.get_be(8))};
+      case 0xcc:
+      case 0xcd:
+      case 0xce:
+      case 0xcf:
+        return {.value =
+                    unsigned_integer(in_.get_be(size_t(1) << (b - 0xcc)))};
+      case 0xd0:
+        return {.value = integer(static_cast<int8_t>(in_.get_be(1)))};
+      case 0xd1:
+        return {.value = integer(static_cast<int16_t>(in_.get_be(2)))};
+      case 0xd2:
+        return {.value = integer(static_cast<int32_t>(in_.get_be(4)))};
+      case 0xd3:
+        return {.value = integer(static_cast<int64_t>(in_.get_be(8)))};
+      case 0xd9:
+      case 0xda:
+      case 0xdb:
+        return {.value = std::string(
+                    in_.take(in_.get_be(size_t(1) << (b - 0xd9))))};
+      case 0xdc:
+      case 0xdd:
+        return array(in_.get_be(b == 0xdc ? 2 : 4));
+      case 0xde:
+      case 0xdf:
+        return object(in_.get_be(b == 0xde ? 2 : 4));
+      default:
+        in_.fail("unsupported type byte " + std::to_string(b));
+    }
+  }
+
+  bool end_of_indefinite() { return false; }
+
+ private:
+  Item array(uint64_t size) {
+    return {.kind = Item::Kind::ARRAY, .size = in_.container_size(size, 1)};
+  }
+
+  Item object(uint64_t size) {
+    return {.kind = Item::Kind::OBJECT, .size = in_.container_size(size, 2)};
+  }
+
+  Input in_;
+};
+
+// Builds the tree with an explicit stack of open containers. Like the text
+// parser, later duplicate keys replace earlier ones.
+template <typename Decoder>
+Value decode(Decoder decoder) {
+  struct Frame {
+    Value* container;
+    size_t remaining;
+    bool indefinite;
+  };
+
+  Value root;
+  std::vector<Frame> stack;
+  Value* slot = &root;
+  while (slot != nullptr) {
+    Item item = decoder.next();
+    switch (item.kind) {
+      case Item::Kind::SCALAR:
+        *slot = std::move(item.value);
+        break;
+      case Item::Kind::ARRAY: {
+        array_t array;
+        array.reserve(item.size);
+        *slot = std::move(array);
+        stack.push_back({slot, item.size, item.indefinite});
+        break;
+      }
+      case Item::Kind::OBJECT:
+        *slot = object_t();
+        stack.push_back({slot, item.size, item.indefinite});
+        break;
+      case Item::Kind::BREAK:
+        decoder.input().fail("unexpected break");
+    }
+
+    slot = nullptr;
+    while (slot == nullptr && !stack.empty()) {
+      Frame& top = stack.back();
+      if (top.indefinite ? decoder.end_of_indefinite() : top.remaining == 0) {
+        stack.pop_back();
+        continue;
+      }
+
+      top.remaining--;
+      if (top.container->is_array()) {
+        array_t& array = *top.container;
+        slot = &array.emplace_back();
+        continue;
+      }
+
+      Item key = decoder.next();
+      if (key.kind != Item::Kind::SCALAR || !key.value.is_string()) {
+        decoder.input().fail("map key is not a string");
+      }
+
+      object_t& object = *top.container;
+      std::string& name = key.value;
+      slot = &object.insert_or_assign(std::move(name), Value()).first->second;
+    }
+  }
+
+  if (!decoder.input().done()) {
+    decoder.input().fail("trailing data");
+  }
+
+  return root;
+}
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+std::string to_cbor(const Value& value) {
+  std::string out;
+  CborEncoder encoder(out);
+  encode(value, encoder);
+  return out;
+}
+
+std::string to_msgpack(const Value& value) {
+  std::string out;
+  MsgpackEncoder encoder(out);
+  encode(value, encoder);
+  return out;
+}
+
+Value from_cbor(std::string_view data) { return decode(CborDecoder(data)); }
+
+Value from_msgpack(std::string_view data) {
+  return decode(MsgpackDecoder(data));
+}
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+// Binary encodings of a Value: CBOR (RFC 8949) and MessagePack.
+//
+// Encoding uses the shortest head for every integer, length and float that
+// keeps the value exact, so a double that fits in a half or single float is
+// written as one. Integrals stay integers and doubles stay floats, which makes
+// decode(encode(v)) == v. Raw values are parsed and encoded as their tree.
+// Sizes past what the format can express throw WriterException.
+std::string to_cbor(const Value& value);
+std::string to_msgpack(const Value& value);
+
+// Decoding reads straight from `data`, which is never copied; each string is
+// built once, in place in its Value. Integers outside int32 become doubles,
+// byte strings become base64url text (RFC 8949 6.1), CBOR tags are dropped
+// and undefined decodes as null. Map keys must be text. Malformed or
+// truncated input, trailing bytes and MessagePack extension types throw
+// ParseException. Runs in bounded stack depth.
+Value from_cbor(std::string_view data);
+Value from_msgpack(std::string_view data);
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,162 @@
+#include "warren/json/utils/codec.h"
+
+#include <cmath>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::Eq;
+
+std::string unhex(std::string_view hex) {
+  std::string res;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    res += static_cast<char>(std::stoi(std::string(hex.substr(i, 2)), 0, 16));
+  }
+
+  return res;
+}
+
+const Value kDocument = R"({
+  "id": 1234567,
+  "name": "café",
+  "tags": ["a", "", "long string with more than thirty-one bytes in it"],
+  "ratio": 0.1,
+  "half": -1.5,
+  "big": 3000000000.0,
+  "small": -129,
+  "nested": {"empty": {}, "list": [[], null, true, false]}
+})"_json;
+
+// RFC 8949 Appendix A.
+TEST(CodecTest, CborEncode) {
+  EXPECT_THAT(to_cbor(0), Eq(unhex("00")));
+  EXPECT_THAT(to_cbor(23), Eq(unhex("17")));
+  EXPECT_THAT(to_cbor(24), Eq(unhex("1818")));
+  EXPECT_THAT(to_cbor(1000), Eq(unhex("1903e8")));
+  EXPECT_THAT(to_cbor(1000000), Eq(unhex("1a000f4240")));
+  EXPECT_THAT(to_cbor(-1), Eq(unhex("20")));
+  EXPECT_THAT(to_cbor(-1000), Eq(unhex("3903e7")));
+  EXPECT_THAT(to_cbor(0.0), Eq(unhex("f90000")));
+  EXPECT_THAT(to_cbor(-0.0), Eq(unhex("f98000")));
+  EXPECT_THAT(to_cbor(1.5), Eq(unhex("f93e00")));
+  EXPECT_THAT(to_cbor(65504.0), Eq(unhex("f97bff")));
+  EXPECT_THAT(to_cbor(5.960464477539063e-8), Eq(unhex("f90001")));
+  EXPECT_THAT(to_cbor(100000.0), Eq(unhex("fa47c35000")));
+  EXPECT_THAT(to_cbor(1.1), Eq(unhex("fb3ff199999999999a")));
+  EXPECT_THAT(to_cbor(INFINITY), Eq(unhex("f97c00")));
+  EXPECT_THAT(to_cbor(NAN), Eq(unhex("f97e00")));
+  EXPECT_THAT(to_cbor(nullptr), Eq(unhex("f6")));
+  EXPECT_THAT(to_cbor(true), Eq(unhex("f5")));
+  EXPECT_THAT(to_cbor("a"), Eq(unhex("6161")));
+  EXPECT_THAT(to_cbor("[1, 2, 3]"_json), Eq(unhex("83010203")));
+  EXPECT_THAT(to_cbor(R"({"a": 1, "b": [2, 3]})"_json),
+              Eq(unhex("a26161016162820203")));
+}
+
+TEST(CodecTest, CborDecode) {
+  EXPECT_THAT(from_cbor(unhex("1903e8")), Eq(Value(1000)));
+  EXPECT_THAT(from_cbor(unhex("3903e7")), Eq(Value(-1000)));
+  EXPECT_THAT(from_cbor(unhex("1b000000e8d4a51000")), Eq(Value(1e12)));
+  EXPECT_THAT(from_cbor(unhex("3bffffffffffffffff")),
+              Eq(Value(-18446744073709551616.0)));
+  EXPECT_THAT(from_cbor(unhex("f93c00")), Eq(Value(1.0)));
+  EXPECT_THAT(from_cbor(unhex("f90400")), Eq(Value(6.103515625e-05)));
+  EXPECT_THAT(from_cbor(unhex("fa7f800000")), Eq(Value(INFINITY)));
+  EXPECT_TRUE(std::isnan(double(from_cbor(unhex("f97e00")))));
+  EXPECT_THAT(from_cbor(unhex("f7")), Eq(Value(nullptr)));
+  EXPECT_THAT(from_cbor(unhex("c11a514b67b0")), Eq(Value(1363896240)));
+  EXPECT_THAT(from_cbor(unhex("4401020304")), Eq(Value("AQIDBA")));
+  EXPECT_THAT(from_cbor(unhex("7f657374726561646d696e67ff")),
+              Eq(Value("streaming")));
+  EXPECT_THAT(from_cbor(unhex("9f018202039f0405ffff")),
+              Eq("[1, [2, 3], [4, 5]]"_json));
+  EXPECT_THAT(from_cbor(unhex("bf61610161629f0203ffff")),
+              Eq(R"({"a": 1, "b": [2, 3]})"_json));
+  EXPECT_THAT(from_cbor(unhex("a2616101616102")), Eq(R"({"a": 2})"_json));
+}
+
+TEST(CodecTest, MsgpackEncode) {
+  EXPECT_THAT(to_msgpack(1), Eq(unhex("01")));
+  EXPECT_THAT(to_msgpack(-1), Eq(unhex("ff")));
+  EXPECT_THAT(to_msgpack(-32), Eq(unhex("e0")));
+  EXPECT_THAT(to_msgpack(200), Eq(unhex("ccc8")));
+  EXPECT_THAT(to_msgpack(300), Eq(unhex("cd012c")));
+  EXPECT_THAT(to_msgpack(70000), Eq(unhex("ce00011170")));
+  EXPECT_THAT(to_msgpack(-100), Eq(unhex("d09c")));
+  EXPECT_THAT(to_msgpack(-200), Eq(unhex("d1ff38")));
+  EXPECT_THAT(to_msgpack(-70000), Eq(unhex("d2fffeee90")));
+  EXPECT_THAT(to_msgpack(1.5), Eq(unhex("ca3fc00000")));
+  EXPECT_THAT(to_msgpack(1.1), Eq(unhex("cb3ff199999999999a")));
+  EXPECT_THAT(to_msgpack(nullptr), Eq(unhex("c0")));
+  EXPECT_THAT(to_msgpack(false), Eq(unhex("c2")));
+  EXPECT_THAT(to_msgpack("a"), Eq(unhex("a161")));
+  EXPECT_THAT(to_msgpack(std::string(32, 'x')),
+              Eq(unhex("d920") + std::string(32, 'x')));
+  EXPECT_THAT(to_msgpack("[1, 2]"_json), Eq(unhex("920102")));
+  EXPECT_THAT(to_msgpack(R"({"a": 1})"_json), Eq(unhex("81a16101")));
+}
+
+TEST(CodecTest, MsgpackDecode) {
+  EXPECT_THAT(from_msgpack(unhex("cf0000000100000000")),
+              Eq(Value(4294967296.0)));
+  EXPECT_THAT(from_msgpack(unhex("d3ffffffffffffff38")), Eq(Value(-200)));
+  EXPECT_THAT(from_msgpack(unhex("c40201ff")), Eq(Value("Af8")));
+  EXPECT_THAT(from_msgpack(unhex("dc0002c3c2")), Eq("[true, false]"_json));
+  EXPECT_THAT(from_msgpack(unhex("de0001a16190")), Eq(R"({"a": []})"_json));
+}
+
+TEST(CodecTest, RoundTrip) {
+  EXPECT_THAT(from_cbor(to_cbor(kDocument)), Eq(kDocument));
+  EXPECT_THAT(from_msgpack(to_msgpack(kDocument)), Eq(kDocument));
+
+  array_t many(70000, Value("x"));
+  EXPECT_THAT(from_cbor(to_cbor(many)), Eq(Value(many)));
+  EXPECT_THAT(from_msgpack(to_msgpack(many)), Eq(Value(many)));
+
+  Value deep = 1;
+  for (int i = 0; i < 100000; i++) {
+    array_t wrapper;
+    wrapper.push_back(std::move(deep));
+    deep = std::move(wrapper);
+  }
+
+  EXPECT_THAT(from_cbor(to_cbor(deep)), Eq(deep));
+  EXPECT_THAT(from_msgpack(to_msgpack(deep)), Eq(deep));
+}
+
+TEST(CodecTest, Raw) {
+  const Value value = array_t{Raw{R"({"a": [1, 2.5]})"}, 3};
+  EXPECT_THAT(from_cbor(to_cbor(value)), Eq(R"([{"a": [1, 2.5]}, 3])"_json));
+  EXPECT_THAT(from_msgpack(to_msgpack(value)),
+              Eq(R"([{"a": [1, 2.5]}, 3])"_json));
+}
+
+TEST(CodecTest, Malformed) {
+  EXPECT_THROW(from_cbor(""), ParseException);
+  EXPECT_THROW(from_cbor(unhex("1a0000")), ParseException);
+  EXPECT_THROW(from_cbor(unhex("0101")), ParseException);
+  EXPECT_THROW(from_cbor(unhex("ff")), ParseException);
+  EXPECT_THROW(from_cbor(unhex("1c")), ParseException);
+  EXPECT_THROW(from_cbor(unhex("a10101")), ParseException);
+  EXPECT_THROW(from_cbor(unhex("9f01")), ParseException);
+  EXPECT_THROW(from_cbor(unhex("9bffffffffffffffff")), ParseException);
+  EXPECT_THROW(from_cbor(unhex("7f4161ff")), ParseException);
+  EXPECT_THROW(from_msgpack(unhex("d40100")), ParseException);
+  EXPECT_THROW(from_msgpack(unhex("ddffffffff")), ParseException);
+  EXPECT_THROW(from_msgpack(unhex("8101c0")), ParseException);
+  EXPECT_THROW(from_msgpack(unhex("a46162")), ParseException);
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,408 @@
+#include "warren/json/utils/columns.h"
+
+#include <cstddef>  // size_t
+#include <cstdint>  // int32_t, uint32_t, uint64_t
+#include <functional>  // equal_to
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>  // move
+#include <vector>
+
+#include "warren/json/parse/lexer.h"
+#include "warren/json/parse/parser.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/value.h"
+
+namespace {
+
+using warren::json::Column;
+using warren::json::Value;
+
+Column::Type type_of(const Value& value) {
+  if (value.is_boolean()) {
+    return Column::BOOLEAN;
+  } else if (value.is_integral()) {
+    return Column::INTEGRAL;
+  } else if (value.is_double()) {
+    return Column::DOUBLE;
+  } else if (value.is_string()) {
+    return Column::STRING;
+  }
+
+  return Column::VALUE;
+}
+
+double number(const Value& value) {
+  return value.is_integral() ? double(int32_t(value)) : double(value);
+}
+
+constexpr size_t kNoCell = static_cast<size_t>(-1);
+
+[[noreturn]] void not_a_record() {
+  throw warren::json::BadAccessException("expected an object record");
+}
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+const Column* Table::find(std::string_view name) const {
+  for (const Column& column : columns) {
+    if (column.name == name) {
+      return &column;
+    }
+  }
+
+  return nullptr;
+}
+
+const Column& Table::at(std::string_view name) const {
+  if (const Column* column = find(name)) {
+    return *column;
+  }
+
+  throw std::out_of_range("column not found: " + std::string(name));
+}
+
+struct ColumnBuilder::Field {
+  // Appends a null row.
+  void push_null() {
+    size_t row = next_row();
+    column.nulls[row / 64] |= uint64_t(1) << (row % 64);
+    push_placeholder();
+  }
+
+  void pad(size_t rows) {
+    while (filled < rows) {
+      push_null();
+    }
+  }
+
+  void push(const Value& value) {
+    if (value.is_null()) {
+      push_null();
+      return;
+    }
+
+    retype(type_of(value));
+    next_row();
+    switch (column.type) {
+      case Column::BOOLEAN:
+        column.booleans.push_back(bool(value));
+        break;
+      case Column::INTEGRAL:
+        column.integers.push_back(int32_t(value));
+        break;
+      case Column::DOUBLE:
+        column.doubles.push_back(number(value));
+        break;
+      case Column::STRING: {
+        const std::string& s = static_cast<const std::string&>(value);
+        auto it = codes.find(std::string_view(s));
+        if (it == codes.end()) {
+          it = codes.emplace(s, static_cast<uint32_t>(codes.size())).first;
+        }
+
+        column.codes.push_back(it->second);
+        break;
+      }
+      default:
+        column.values.push_back(value);
+        break;
+    }
+  }
+
+  // Moves the column to a type that can also hold values of type `type`:
+  // integrals widen to doubles, and any other mix falls back to Values.
+  void retype(Column::Type type) {
+    if (type == column.type || column.type == Column::VALUE ||
+        (type == Column::INTEGRAL && column.type == Column::DOUBLE)) {
+      return;
+    }
+
+    Column::Type from = column.type;
+    if (from == Column::JSON_NULL) {
+      column.type = type;
+      for (size_t row = 0; row < filled; row++) {
+        push_placeholder();
+      }
+    } else if (from == Column::INTEGRAL && type == Column::DOUBLE) {
+      column.type = Column::DOUBLE;
+      column.doubles.assign(column.integers.begin(), column.integers.end());
+      column.integers = {};
+    } else {
+      std::vector<const std::string*> strings(codes.size());
+      for (const auto& [s, code] : codes) {
+        strings[code] = &s;
+      }
+
+      column.type = Column::VALUE;
+      column.values.reserve(filled);
+      for (size_t row = 0; row < filled; row++) {
+        if (column.is_null(row)) {
+          column.values.emplace_back(nullptr);
+        } else if (from == Column::BOOLEAN) {
+          column.values.emplace_back(column.booleans[row] != 0);
+        } else if (from == Column::INTEGRAL) {
+          column.values.emplace_back(column.integers[row]);
+        } else if (from == Column::DOUBLE) {
+          column.values.emplace_back(column.doubles[row]);
+        } else {
+          column.values.emplace_back(*strings[column.codes[row]]);
+        }
+      }
+
+      column.booleans = {};
+      column.integers = {};
+      column.doubles = {};
+      column.codes = {};
+      codes = {};
+    }
+  }
+
+  Column column;
+
+  // Rows in `column`, including null placeholders.
+  size_t filled = 0;
+
+  // Index in ColumnBuilder::row_ of this field's cell in the record being
+  // parsed, if it has one yet.
+  size_t cell = kNoCell;
+
+  // Code of each distinct string while the column holds strings.
+  std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> codes;
+
+ private:
+  size_t next_row() {
+    if (filled % 64 == 0) {
+      column.nulls.push_back(0);
+    }
+
+    return filled++;
+  }
+
+  void push_placeholder() {
+    switch (column.type) {
+      case Column::JSON_NULL:
+        break;
+      case Column::BOOLEAN:
+        column.booleans.push_back(0);
+        break;
+      case Column::INTEGRAL:
+        column.integers.push_back(0);
+        break;
+      case Column::DOUBLE:
+        column.doubles.push_back(0);
+        break;
+      case Column::STRING:
+        column.codes.push_back(0);
+        break;
+      case Column::VALUE:
+        column.values.emplace_back(nullptr);
+        break;
+    }
+  }
+};
+
+ColumnBuilder::ColumnBuilder() = default;
+ColumnBuilder::~ColumnBuilder() = default;
+
+ColumnBuilder::ColumnBuilder(ColumnBuilder&&) noexcept = default;
+ColumnBuilder& ColumnBuilder::operator=(ColumnBuilder&&) noexcept = default;
+
+void ColumnBuilder::append(const Value& record) {
+  if (record.is_raw()) {
+    append(parse(record.raw()));
+    return;
+  } else if (!record.is_object()) {
+    not_a_record();
+  }
+
+  // Members of a Value are unique, so they need not wait for the end of the
+  // row.
+  for (auto it = record.begin(); it != record.end(); ++it) {
+    store(column(it.key()), *it);
+  }
+
+  end_row();
+}
+
+void ColumnBuilder::scalar(Value value) {
+  if (member_) {
+    member_->scalar(std::move(value));
+  } else if (in_record_) {
+    cell(key_, std::move(value));
+  } else {
+    not_a_record();
+  }
+}
+
+void ColumnBuilder::begin_array() {
+  if (in_record_) {
+    open_member();
+    member_->begin_array();
+  } else if (!in_array_) {
+    in_array_ = true;
+  } else {
+    not_a_record();
+  }
+}
+
+void ColumnBuilder::end_array() {
+  if (in_record_) {
+    member_->end_array();
+    close_member();
+  } else {
+    in_array_ = false;
+  }
+}
+
+void ColumnBuilder::begin_object() {
+  if (in_record_) {
+    open_member();
+    member_->begin_object();
+  } else {
+    in_record_ = true;
+  }
+}
+
+void ColumnBuilder::key(std::string key) {
+  if (member_) {
+    member_->key(std::move(key));
+  } else {
+    key_ = std::move(key);
+  }
+}
+
+void ColumnBuilder::end_object() {
+  if (member_) {
+    member_->end_object();
+    close_member();
+  } else {
+    in_record_ = false;
+    end_row();
+  }
+}
+
+Table ColumnBuilder::release() {
+  Table table;
+  table.rows = rows_;
+  table.columns.reserve(fields_.size());
+  for (Field& field : fields_) {
+    field.pad(rows_);
+    if (field.column.type == Column::STRING) {
+      field.column.dictionary.resize(field.codes.size());
+      while (!field.codes.empty()) {
+        auto node = field.codes.extract(field.codes.begin());
+        field.column.dictionary[node.mapped()] = std::move(node.key());
+      }
+    }
+
+    table.columns.push_back(std::move(field.column));
+  }
+
+  *this = ColumnBuilder();
+  return table;
+}
+
+size_t ColumnBuilder::column(std::string_view name) {
+  size_t i;
+  if (position_ < order_.size() &&
+      fields_[order_[position_]].column.name == name) {
+    i = order_[position_];
+  } else {
+    auto it = by_name_.find(name);
+    if (it == by_name_.end()) {
+      it = by_name_.emplace(name, fields_.size()).first;
+      fields_.emplace_back().column.name = name;
+    }
+
+    i = it->second;
+    if (position_ < order_.size()) {
+      order_[position_] = i;
+    } else {
+      order_.push_back(i);
+    }
+  }
+
+  position_++;
+  return i;
+}
+
+void ColumnBuilder::cell(std::string_view name, Value value) {
+  size_t i = column(name);
+  Field& field = fields_[i];
+  if (field.cell != kNoCell) {
+    row_[field.cell].second = std::move(value);
+  } else {
+    field.cell = row_.size();
+    row_.emplace_back(i, std::move(value));
+  }
+}
+
+void ColumnBuilder::store(size_t column, const Value& value) {
+  if (value.is_raw()) {
+    store(column, parse(value.raw()));
+    return;
+  }
+
+  Field& field = fields_[column];
+  field.pad(rows_);
+  field.push(value);
+}
+
+void ColumnBuilder::end_row() {
+  for (const auto& [column, value] : row_) {
+    fields_[column].cell = kNoCell;
+    store(column, value);
+  }
+
+  row_.clear();
+  rows_++;
+  position_ = 0;
+}
+
+void ColumnBuilder::open_member() {
+  if (!member_) {
+    member_.emplace();
+  }
+
+  member_depth_++;
+}
+
+void ColumnBuilder::close_member() {
+  if (--member_depth_ == 0) {
+    cell(key_, member_->release());
+    member_.reset();
+  }
+}
+
+Table to_columns(const Value& records) {
+  if (records.is_raw()) {
+    return to_columns(parse(records.raw()));
+  }
+
+  ColumnBuilder builder;
+  if (records.is_array()) {
+    for (const Value& record : records) {
+      builder.append(record);
+    }
+  } else {
+    builder.append(records);
+  }
+
+  return builder.release();
+}
+
+Table parse_columns(std::string json) {
+  ColumnBuilder builder;
+  Parser(Lexer(std::move(json))).parse(builder);
+  return builder.release();
+}
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // int32_t, uint8_t, uint32_t, uint64_t
+#include <functional>  // equal_to, hash
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>  // pair
+#include <vector>
+
+#include "warren/json/parse/parser.h"
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+// One field of a table of records, stored by row. Only the vector matching
+// `type` is filled, with one entry per row; rows where the field is null or
+// missing hold a zero or empty placeholder there and are marked in `nulls`.
+struct Column {
+  enum Type {
+    JSON_NULL,  // every row is null or missing
+    BOOLEAN,
+    INTEGRAL,
+    DOUBLE,  // also holds integrals when a column mixes both
+    STRING,
+    VALUE  // mixed types, arrays and objects
+  };
+
+  bool is_null(size_t row) const noexcept {
+    return (nulls[row / 64] >> (row % 64) & 1) != 0;
+  }
+
+  bool operator==(const Column&) const = default;
+
+  std::string name;
+  Type type = JSON_NULL;
+
+  // Bit `row % 64` of word `row / 64` is set when the row is null or missing.
+  std::vector<uint64_t> nulls;
+
+  std::vector<uint8_t> booleans;
+  std::vector<int32_t> integers;
+  std::vector<double> doubles;
+
+  // Strings are dictionary-encoded: the row holds dictionary[codes[row]].
+  // Codes are assigned in order of first appearance.
+  std::vector<uint32_t> codes;
+  std::vector<std::string> dictionary;
+
+  std::vector<Value> values;
+};
+
+// Struct-of-arrays form of a list of objects. Columns are in order of the
+// first record each field appears in.
+struct Table {
+  const Column* find(std::string_view name) const;
+
+  // Throws std::out_of_range if there is no column `name`.
+  const Column& at(std::string_view name) const;
+
+  bool operator==(const Table&) const = default;
+
+  size_t rows = 0;
+  std::vector<Column> columns;
+};
+
+// Builds a Table one record at a time, either from Values or as a
+// ParseHandler straight from the parser's events, without materializing the
+// records. A document may be an array of records or a single record, so
+// parsing each line of NDJSON into the same builder appends a row per line.
+// Records that are not objects throw BadAccessException. Later duplicate keys
+// replace earlier ones.
+class ColumnBuilder final : public ParseHandler {
+ public:
+  ColumnBuilder();
+  ~ColumnBuilder() override;
+
+  ColumnBuilder(ColumnBuilder&&) noexcept;
+  ColumnBuilder& operator=(ColumnBuilder&&) noexcept;
+
+  ColumnBuilder(const ColumnBuilder&) = delete;
+  ColumnBuilder& operator=(const ColumnBuilder&) = delete;
+
+  // Appends `record` as one row. Raw values are parsed first.
+  void append(const Value& record);
+
+  void scalar(Value value) override;
+  void begin_array() override;
+  void end_array() override;
+  void begin_object() override;
+  void key(std::string key) override;
+  void end_object() override;
+
+  // Returns the rows appended so far and resets the builder.
+  Table release();
+
+ private:
+  struct Field;
+
+  // Lets names be looked up by std::string_view without a copy.
+  struct NameHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view name) const noexcept {
+      return std::hash<std::string_view>()(name);
+    }
+  };
+
+  size_t column(std::string_view name);
+  // Buffers a parsed member until the end of its record, so that a later
+  // duplicate key replaces it before it affects the column's type.
+  void cell(std::string_view name, Value value);
+  void store(size_t column, const Value& value);
+  void end_row();
+
+  // Routes the events of an array or object member to `member_`.
+  void open_member();
+  void close_member();
+
+  // Rows appended so far, not counting one in progress.
+  size_t rows_ = 0;
+  std::vector<Field> fields_;
+  std::unordered_map<std::string, size_t, NameHash, std::equal_to<>> by_name_;
+
+  // Cells of the record being parsed, by column.
+  std::vector<std::pair<size_t, Value>> row_;
+
+  // The columns of the previous row's members, by position. Records usually
+  // share a key order, so this predicts each member's column without a hash
+  // lookup.
+  std::vector<size_t> order_;
+  size_t position_ = 0;
+
+  // Event state: inside a top-level array, inside a record, and the subtree
+  // being built for a member that is an array or object.
+  bool in_array_ = false;
+  bool in_record_ = false;
+  std::string key_;
+  std::optional<TreeBuilder> member_;
+  size_t member_depth_ = 0;
+};
+
+// `records` is an array of objects, or a single object for one row.
+Table to_columns(const Value& records);
+
+// Converts `json` from the parser's events, without building its tree.
+Table parse_columns(std::string json);
+
+}  // namespace json
+}  // namespace warren
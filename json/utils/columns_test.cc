@@ -0,0 +1,177 @@
+#include "warren/json/utils/columns.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/parse/lexer.h"
+#include "warren/json/parse/parser.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/utils/to_string.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+
+const char* const kRecords = R"([
+  {"id": 1, "name": "Oslo", "capital": true, "area": 454, "tags": ["port"]},
+  {"id": 2, "name": "Bergen", "capital": false, "area": 465.3},
+  {"id": 3, "name": "Oslo", "area": null, "note": "again"},
+  {"name": "Tromsø", "id": 4, "capital": null, "tags": {"a": 1}}
+])";
+
+// Columns are in order of first appearance, which is document order when
+// streaming but key order for a Value.
+Table by_name(Table table) {
+  std::sort(table.columns.begin(), table.columns.end(),
+            [](const Column& lhs, const Column& rhs) {
+              return lhs.name < rhs.name;
+            });
+  return table;
+}
+
+TEST(ColumnsTest, Types) {
+  const Table table = to_columns(parse(kRecords));
+  ASSERT_THAT(table.rows, Eq(4u));
+  ASSERT_THAT(table.columns.size(), Eq(6u));
+  EXPECT_THAT(table.columns[0].name, Eq("area"));
+
+  const Column& id = table.at("id");
+  EXPECT_THAT(id.type, Eq(Column::INTEGRAL));
+  EXPECT_THAT(id.integers, ElementsAre(1, 2, 3, 4));
+  EXPECT_THAT(id.nulls, ElementsAre(0u));
+
+  const Column& name = table.at("name");
+  EXPECT_THAT(name.type, Eq(Column::STRING));
+  EXPECT_THAT(name.dictionary, ElementsAre("Oslo", "Bergen", "Tromsø"));
+  EXPECT_THAT(name.codes, ElementsAre(0u, 1u, 0u, 2u));
+
+  const Column& capital = table.at("capital");
+  EXPECT_THAT(capital.type, Eq(Column::BOOLEAN));
+  EXPECT_THAT(capital.booleans, ElementsAre(1, 0, 0, 0));
+  EXPECT_FALSE(capital.is_null(1));
+  EXPECT_TRUE(capital.is_null(2));
+  EXPECT_TRUE(capital.is_null(3));
+
+  // Integrals widen to doubles.
+  const Column& area = table.at("area");
+  EXPECT_THAT(area.type, Eq(Column::DOUBLE));
+  EXPECT_THAT(area.doubles, ElementsAre(454.0, 465.3, 0.0, 0.0));
+  EXPECT_THAT(area.nulls, ElementsAre(0b1100u));
+
+  // Mixed types fall back to Values.
+  const Column& tags = table.at("tags");
+  EXPECT_THAT(tags.type, Eq(Column::VALUE));
+  EXPECT_THAT(tags.values, ElementsAre(parse(R"(["port"])"), nullptr,
+                                       nullptr, parse(R"({"a": 1})")));
+
+  const Column& note = table.at("note");
+  EXPECT_THAT(note.codes, ElementsAre(0u, 0u, 0u, 0u));
+  EXPECT_THAT(note.nulls, ElementsAre(0b1011u));
+
+  EXPECT_THAT(table.find("missing"), Eq(nullptr));
+  EXPECT_THROW(table.at("missing"), std::out_of_range);
+}
+
+TEST(ColumnsTest, Retype) {
+  const Table table = to_columns(parse(R"([
+    {"a": null, "b": "x", "c": 1},
+    {"a": null, "b": 2, "c": "y"},
+    {"a": null, "b": "x", "c": 1.5}
+  ])"));
+
+  EXPECT_THAT(table.at("a").type, Eq(Column::JSON_NULL));
+  EXPECT_THAT(table.at("a").nulls, ElementsAre(0b111u));
+  EXPECT_THAT(table.at("b").values, ElementsAre("x", 2, "x"));
+  EXPECT_THAT(table.at("c").values, ElementsAre(1, "y", 1.5));
+  EXPECT_TRUE(table.at("b").dictionary.empty());
+}
+
+TEST(ColumnsTest, NullBitmapSpansWords) {
+  array_t records;
+  for (int i = 0; i < 130; i++) {
+    records.push_back(i % 3 == 0 ? parse(R"({"a": 1})") : parse("{}"));
+  }
+
+  const Table table = to_columns(records);
+  const Column& a = table.at("a");
+  ASSERT_THAT(a.nulls.size(), Eq(3u));
+  for (size_t row = 0; row < 130; row++) {
+    EXPECT_THAT(a.is_null(row), Eq(row % 3 != 0)) << row;
+  }
+}
+
+TEST(ColumnsTest, DuplicateKeys) {
+  const Table table = to_columns(parse(R"([{"a": 1}, {"a": 2}])"));
+  ColumnBuilder builder;
+  Parser(Lexer(R"([{"a": 1}, {"a": 5, "a": 2}])")).parse(builder);
+  EXPECT_THAT(builder.release(), Eq(table));
+
+  Parser(Lexer(R"({"a": null, "a": 1})")).parse(builder);
+  Parser(Lexer(R"({"a": 2, "a": null})")).parse(builder);
+  const Table rows = builder.release();
+  const Column& a = rows.at("a");
+  EXPECT_THAT(a.integers, ElementsAre(1, 0));
+  EXPECT_THAT(a.nulls, ElementsAre(0b10u));
+
+  // A replaced member leaves no trace in the column's type or dictionary.
+  const char* const json = R"([{"a": 1, "a": "x"}, {"a": "y"}])";
+  const Table parsed = parse_columns(json);
+  EXPECT_THAT(parsed, Eq(to_columns(parse(json))));
+  EXPECT_THAT(parsed.at("a").type, Eq(Column::STRING));
+  EXPECT_THAT(parsed.at("a").dictionary, ElementsAre("x", "y"));
+}
+
+TEST(ColumnsTest, Stream) {
+  const Table table = parse_columns(kRecords);
+  EXPECT_THAT(table.columns[0].name, Eq("id"));
+  EXPECT_THAT(by_name(table), Eq(by_name(to_columns(parse(kRecords)))));
+  EXPECT_THAT(parse_columns("[]").rows, Eq(0u));
+
+  const Value deep = parse(R"([{"a": [[{"b": []}], {}]}, {"a": 1}])");
+  EXPECT_THAT(by_name(parse_columns(to_string(deep))),
+              Eq(by_name(to_columns(deep))));
+}
+
+TEST(ColumnsTest, Ndjson) {
+  std::istringstream lines(R"({"a": 1, "b": "x"}
+{"b": "y"}
+{"a": 3, "c": true})");
+
+  ColumnBuilder builder;
+  for (std::string line; std::getline(lines, line);) {
+    Parser(Lexer(line)).parse(builder);
+  }
+
+  EXPECT_THAT(by_name(builder.release()),
+              Eq(by_name(to_columns(parse(R"([{"a": 1, "b": "x"}, {"b": "y"},
+                                              {"a": 3, "c": true}])")))));
+}
+
+TEST(ColumnsTest, Raw) {
+  const Value records = array_t{Raw{R"({"a": 1})"}, parse(R"({"a": 2})")};
+  EXPECT_THAT(to_columns(records).at("a").integers, ElementsAre(1, 2));
+  EXPECT_THAT(to_columns(Raw{"[]"}).rows, Eq(0u));
+}
+
+TEST(ColumnsTest, NotRecords) {
+  EXPECT_THROW(to_columns(parse("[1]")), BadAccessException);
+  EXPECT_THROW(to_columns(parse("[[]]")), BadAccessException);
+  EXPECT_THROW(to_columns(parse("null")), BadAccessException);
+  EXPECT_THROW(parse_columns("[1]"), BadAccessException);
+  EXPECT_THROW(parse_columns("[[{}]]"), BadAccessException);
+  EXPECT_THROW(parse_columns("true"), BadAccessException);
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,411 @@
+#include "warren/json/utils/diff.h"
+
+#include <cstddef>  // ptrdiff_t, size_t
+#include <cstdint>  // uint64_t
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "warren/json/utils/hash.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/value.h"
+
+namespace {
+
+using warren::json::array_t;
+using warren::json::object_t;
+using warren::json::Value;
+
+enum class Edit { KEEP, REMOVE, INSERT };
+
+// Myers' O((N + M) D) diff in linear space: finds the middle snake of the
+// shortest edit script, then recurses on both halves.
+// http://www.xmailserver.org/diff2.pdf
+class Myers {
+ public:
+  Myers(const std::vector<size_t>& a, const std::vector<size_t>& b)
+      : a_(a), b_(b) {}
+
+  std::vector<Edit> run() {
+    diff(0, a_.size(), 0, b_.size());
+    return std::move(edits_);
+  }
+
+ private:
+  void diff(size_t a0, size_t a1, size_t b0, size_t b1) {
+    while (a0 < a1 && b0 < b1 && a_[a0] == b_[b0]) {
+      a0++;
+      b0++;
+      edits_.push_back(Edit::KEEP);
+    }
+
+    size_t suffix = 0;
+    while (a0 < a1 && b0 < b1 && a_[a1 - 1] == b_[b1 - 1]) {
+      a1--;
+      b1--;
+      suffix++;
+    }
+
+    if (a0 == a1) {
+      edits_.insert(edits_.end(), b1 - b0, Edit::INSERT);
+    } else if (b0 == b1) {
+      edits_.insert(edits_.end(), a1 - a0, Edit::REMOVE);
+    } else {
+      bisect(a0, a1, b0, b1);
+    }
+
+    edits_.insert(edits_.end(), suffix, Edit::KEEP);
+  }
+
+  // Walks the forward and reverse paths in lockstep until they overlap, then
+  // splits the problem at the overlap.
+  void bisect(size_t a0, size_t a1, size_t b0, size_t b1) {
+    const ptrdiff_t n = ptrdiff_t(a1 - a0);
+    const ptrdiff_t m = ptrdiff_t(b1 - b0);
+    const ptrdiff_t max_d = (n + m + 1) / 2;
+    const ptrdiff_t offset = max_d;
+    const ptrdiff_t delta = n - m;
+    const bool front = delta % 2 != 0;
+    std::vector<ptrdiff_t> forward(size_t(2 * max_d + 2), -1);
+    std::vector<ptrdiff_t> reverse(size_t(2 * max_d + 2), -1);
+    forward[size_t(offset + 1)] = 0;
+    reverse[size_t(offset + 1)] = 0;
+
+    auto a = [&](ptrdiff_t i) { return a_[a0 + size_t(i)]; };
+    auto b = [&](ptrdiff_t i) { return b_[b0 + size_t(i)]; };
+
+    ptrdiff_t k1_start = 0;
+    ptrdiff_t k1_end = 0;
+    ptrdiff_t k2_start = 0;
+    ptrdiff_t k2_end = 0;
+    for (ptrdiff_t d = 0; d < max_d; d++) {
+      for (ptrdiff_t k1 = -d + k1_start; k1 <= d - k1_end; k1 += 2) {
+        size_t k1_offset = size_t(offset + k1);
+        ptrdiff_t x1 = (k1 == -d || (k1 != d && forward[k1_offset - 1] <
+                                                    forward[k1_offset + 1]))
+                           ? forward[k1_offset + 1]
+                           : forward[k1_offset - 1] + 1;
+        ptrdiff_t y1 = x1 - k1;
+        while (x1 < n && y1 < m && a(x1) == b(y1)) {
+          x1++;
+          y1++;
+        }
+
+        forward[k1_offset] = x1;
+        if (x1 > n) {
+          k1_end += 2;
+        } else if (y1 > m) {
+          k1_start += 2;
+        } else if (front) {
+          ptrdiff_t k2_offset = offset + delta - k1;
+          if (k2_offset >= 0 && k2_offset < ptrdiff_t(reverse.size()) &&
+              reverse[size_t(k2_offset)] != -1 &&
+              x1 >= n - reverse[size_t(k2_offset)]) {
+            return split(a0, a1, b0, b1, size_t(x1), size_t(y1));
+          }
+        }
+      }
+
+      for (ptrdiff_t k2 = -d + k2_start; k2 <= d - k2_end; k2 += 2) {
+        size_t k2_offset = size_t(offset + k2);
+        ptrdiff_t x2 = (k2 == -d || (k2 != d && reverse[k2_offset - 1] <
+                                                    reverse[k2_offset + 1]))
+                           ? reverse[k2_offset + 1]
+                           : reverse[k2_offset - 1] + 1;
+        ptrdiff_t y2 = x2 - k2;
+        while (x2 < n && y2 < m && a(n - x2 - 1) == b(m - y2 - 1)) {
+          x2++;
+          y2++;
+        }
+
+        reverse[k2_offset] = x2;
+        if (x2 > n) {
+          k2_end += 2;
+        } else if (y2 > m) {
+          k2_start += 2;
+        } else if (!front) {
+          ptrdiff_t k1_offset = offset + delta - k2;
+          if (k1_offset >= 0 && k1_offset < ptrdiff_t(forward.size()) &&
+              forward[size_t(k1_offset)] != -1) {
+            ptrdiff_t x1 = forward[size_t(k1_offset)];
+            ptrdiff_t y1 = offset + x1 - k1_offset;
+            if (x1 >= n - x2) {
+              return split(a0, a1, b0, b1, size_t(x1), size_t(y1));
+            }
+          }
+        }
+      }
+    }
+
+    // Nothing in common.
+    edits_.insert(edits_.end(), a1 - a0, Edit::REMOVE);
+    edits_.insert(edits_.end(), b1 - b0, Edit::INSERT);
+  }
+
+  void split(size_t a0, size_t a1, size_t b0, size_t b1, size_t x, size_t y) {
+    diff(a0, a0 + x, b0, b0 + y);
+    diff(a0 + x, a1, b0 + y, b1);
+  }
+
+  const std::vector<size_t>& a_;
+  const std::vector<size_t>& b_;
+  std::vector<Edit> edits_;
+};
+
+// Numbers the elements of both arrays so that equal elements, and only equal
+// elements, share an id. Hashes bucket the candidates; operator== settles
+// collisions. `containers` holds the hashes of the containers of both trees,
+// so only scalars are hashed here.
+std::pair<std::vector<size_t>, std::vector<size_t>> intern(
+    const array_t& a, const array_t& b,
+    const std::unordered_map<const Value*, uint64_t>& containers) {
+  std::unordered_map<uint64_t, std::vector<std::pair<const Value*, size_t>>>
+      buckets;
+  size_t next = 0;
+  auto id = [&](const Value& value) {
+    auto it = containers.find(&value);
+    uint64_t h =
+        it != containers.end() ? it->second : warren::json::hash(value);
+    auto& bucket = buckets[h];
+    for (const auto& [seen, seen_id] : bucket) {
+      if (*seen == value) {
+        return seen_id;
+      }
+    }
+
+    bucket.emplace_back(&value, next);
+    return next++;
+  };
+
+  std::vector<size_t> a_ids;
+  a_ids.reserve(a.size());
+  for (const Value& value : a) {
+    a_ids.push_back(id(value));
+  }
+
+  std::vector<size_t> b_ids;
+  b_ids.reserve(b.size());
+  for (const Value& value : b) {
+    b_ids.push_back(id(value));
+  }
+
+  return {std::move(a_ids), std::move(b_ids)};
+}
+
+std::string escape(const std::string& token) {
+  std::string escaped;
+  escaped.reserve(token.size());
+  for (char c : token) {
+    if (c == '~') {
+      escaped += "~0";
+    } else if (c == '/') {
+      escaped += "~1";
+    } else {
+      escaped += c;
+    }
+  }
+
+  return escaped;
+}
+
+// Walks both trees from an explicit stack of container pairs, so deeply
+// nested values do not recurse. Operations are emitted in the order a
+// recursive walk would produce them, which array indices depend on.
+class Differ {
+ public:
+  Value run(const Value& from, const Value& to) {
+    warren::json::hash(from, hashes_);
+    warren::json::hash(to, hashes_);
+    enter(from, to);
+    while (!stack_.empty()) {
+      Frame& top = stack_.back();
+      path_.resize(top.length);
+      if (!(top.object ? step_object(top) : step_array(top))) {
+        stack_.pop_back();
+      }
+    }
+
+    return std::move(patch_);
+  }
+
+ private:
+  // A pair of containers being diffed. `length` is the size of path_ at
+  // them; the rest is where to resume.
+  struct Frame {
+    size_t length;
+    bool object;
+    object_t::const_iterator from_member = {};
+    object_t::const_iterator from_end = {};
+    object_t::const_iterator to_member = {};
+    object_t::const_iterator to_end = {};
+    const array_t* from_array = nullptr;
+    const array_t* to_array = nullptr;
+    std::vector<Edit> edits = {};
+    size_t e = 0;
+    size_t index = 0;
+    size_t i = 0;
+    size_t j = 0;
+    size_t removes = 0;
+    size_t inserts = 0;
+  };
+
+  // Diffs two values at path_. Returns true if they are containers of the
+  // same kind, for which a frame was pushed.
+  bool enter(const Value& from, const Value& to) {
+    if (&from == &to) {
+      return false;
+    }
+
+    const object_t* from_object = from.get_if<object_t>();
+    const object_t* to_object = to.get_if<object_t>();
+    if (from_object && to_object) {
+      stack_.push_back({.length = path_.size(),
+                        .object = true,
+                        .from_member = from_object->begin(),
+                        .from_end = from_object->end(),
+                        .to_member = to_object->begin(),
+                        .to_end = to_object->end()});
+      return true;
+    }
+
+    const array_t* from_array = from.get_if<array_t>();
+    const array_t* to_array = to.get_if<array_t>();
+    if (from_array && to_array) {
+      auto [from_ids, to_ids] = intern(*from_array, *to_array, hashes_);
+      stack_.push_back({.length = path_.size(),
+                        .object = false,
+                        .from_array = from_array,
+                        .to_array = to_array,
+                        .edits = Myers(from_ids, to_ids).run()});
+      return true;
+    }
+
+    if (!(from == to)) {
+      emit("replace", path_, to);
+    }
+
+    return false;
+  }
+
+  // Merges the sorted members of both objects. Returns true once it has
+  // pushed a frame for a member, false when the objects are done.
+  bool step_object(Frame& frame) {
+    while (frame.from_member != frame.from_end ||
+           frame.to_member != frame.to_end) {
+      path_.resize(frame.length);
+      auto& from = frame.from_member;
+      auto& to = frame.to_member;
+      if (to == frame.to_end ||
+          (from != frame.from_end && from->first < to->first)) {
+        path_ += "/" + escape(from->first);
+        emit("remove", path_);
+        ++from;
+      } else if (from == frame.from_end || to->first < from->first) {
+        path_ += "/" + escape(to->first);
+        emit("add", path_, to->second);
+        ++to;
+      } else {
+        path_ += "/" + escape(to->first);
+        const Value& from_value = (from++)->second;
+        const Value& to_value = (to++)->second;
+        // `frame` may not outlive a push.
+        if (enter(from_value, to_value)) {
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  // Replays the edit script against a running index into the array as the
+  // patch has left it so far. A run of removals next to a run of insertions
+  // is paired up element by element and diffed recursively. Returns true
+  // once it has pushed a frame for a pair, false when the arrays are done.
+  bool step_array(Frame& frame) {
+    const array_t& from = *frame.from_array;
+    const array_t& to = *frame.to_array;
+    while (true) {
+      if (frame.removes > 0 && frame.inserts > 0) {
+        frame.removes--;
+        frame.inserts--;
+        path_.resize(frame.length);
+        path_ += "/" + std::to_string(frame.index++);
+        // `frame` may not outlive a push.
+        if (enter(from[frame.i++], to[frame.j++])) {
+          return true;
+        }
+
+        continue;
+      }
+
+      path_.resize(frame.length);
+      for (; frame.removes > 0; frame.removes--, frame.i++) {
+        emit("remove", path_ + "/" + std::to_string(frame.index));
+      }
+
+      for (; frame.inserts > 0; frame.inserts--) {
+        emit("add", path_ + "/" + std::to_string(frame.index++),
+             to[frame.j++]);
+      }
+
+      const std::vector<Edit>& edits = frame.edits;
+      if (frame.e == edits.size()) {
+        return false;
+      }
+
+      if (edits[frame.e] == Edit::KEEP) {
+        frame.index++;
+        frame.i++;
+        frame.j++;
+        frame.e++;
+        continue;
+      }
+
+      for (; frame.e < edits.size() && edits[frame.e] != Edit::KEEP;
+           frame.e++) {
+        (edits[frame.e] == Edit::REMOVE ? frame.removes : frame.inserts)++;
+      }
+    }
+  }
+
+  void emit(const char* op, const std::string& path) {
+    Value& entry = patch_.emplace_back(object_t{});
+    entry.insert("op", op);
+    entry.insert("path", path);
+  }
+
+  void emit(const char* op, const std::string& path, const Value& value) {
+    Value& entry = patch_.emplace_back(object_t{});
+    entry.insert("op", op);
+    entry.insert("path", path);
+    entry.insert("value", value);
+  }
+
+  std::unordered_map<const Value*, uint64_t> hashes_;
+  std::vector<Frame> stack_;
+  std::string path_;
+  Value patch_ = array_t{};
+};
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+// Expands copies so that the inputs stay untouched.
+Value diff(const Value& from, const Value& to) {
+  if (!contains_raw(from) && !contains_raw(to)) {
+    return Differ().run(from, to);
+  }
+
+  Value from_tree = from;
+  expand(from_tree);
+  Value to_tree = to;
+  expand(to_tree);
+  return Differ().run(from_tree, to_tree);
+}
+
+}  // namespace json
+}  // namespace warren
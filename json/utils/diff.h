@@ -0,0 +1,20 @@
+#pragma once
+
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+// Returns an RFC 6902 JSON Patch that turns `from` into `to`:
+//
+//   apply_patch(from, diff(from, to));  // from == to
+//
+// Objects are diffed member by member in one merge pass over both sorted
+// maps. Array elements are matched with Myers' linear-space diff over
+// element hashes, and a changed element paired with a changed element is
+// diffed recursively instead of being replaced wholesale. Raw values are
+// diffed by their parsed trees.
+Value diff(const Value& from, const Value& to);
+
+}  // namespace json
+}  // namespace warren
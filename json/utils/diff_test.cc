@@ -0,0 +1,151 @@
+#include "warren/json/utils/diff.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/utils/patch.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::Eq;
+
+void ExpectRoundTrip(Value from, const Value& to) {
+  Value patch = diff(from, to);
+  apply_patch(from, patch);
+  EXPECT_THAT(from, Eq(to));
+}
+
+TEST(DiffTest, Identical) {
+  Value doc = R"({"a": [1, {"b": null}], "c": "d"})"_json;
+  EXPECT_THAT(diff(doc, doc), Eq(array_t{}));
+  EXPECT_THAT(diff(doc, Value(doc)), Eq(array_t{}));
+}
+
+TEST(DiffTest, Scalars) {
+  EXPECT_THAT(diff("1"_json, "2"_json),
+              Eq(R"([{"op": "replace", "path": "", "value": 2}])"_json));
+  EXPECT_THAT(diff("1"_json, "1.0"_json), Eq(array_t{}));
+  EXPECT_THAT(diff("[]"_json, "{}"_json),
+              Eq(R"([{"op": "replace", "path": "", "value": {}}])"_json));
+}
+
+TEST(DiffTest, Object) {
+  EXPECT_THAT(diff(R"({"a": 1, "b": {"c": 2, "d": 3}, "e/~": 4})"_json,
+                   R"({"b": {"c": 2, "d": 5}, "e/~": 4, "f": 6})"_json),
+              Eq(R"([
+                {"op": "remove", "path": "/a"},
+                {"op": "replace", "path": "/b/d", "value": 5},
+                {"op": "add", "path": "/f", "value": 6}
+              ])"_json));
+}
+
+TEST(DiffTest, EscapesKeys) {
+  EXPECT_THAT(diff(R"({"a/b": 1, "m~n": 2})"_json,
+                   R"({"a/b": 2, "m~n": 2})"_json),
+              Eq(R"([{"op": "replace", "path": "/a~1b", "value": 2}])"_json));
+}
+
+TEST(DiffTest, ArrayInsertAndRemove) {
+  EXPECT_THAT(diff("[1, 2, 3, 4]"_json, "[1, 3, 4, 5]"_json),
+              Eq(R"([
+                {"op": "remove", "path": "/1"},
+                {"op": "add", "path": "/3", "value": 5}
+              ])"_json));
+}
+
+TEST(DiffTest, ArrayChangedElementIsDiffedRecursively) {
+  EXPECT_THAT(diff(R"([{"id": 1, "v": "a"}, {"id": 2, "v": "b"}])"_json,
+                   R"([{"id": 1, "v": "a"}, {"id": 2, "v": "c"}])"_json),
+              Eq(R"([{"op": "replace", "path": "/1/v", "value": "c"}])"_json));
+}
+
+TEST(DiffTest, RoundTrip) {
+  std::vector<std::pair<const char*, const char*>> cases = {
+      {"[]", "[1, 2, 3]"},
+      {"[1, 2, 3]", "[]"},
+      {"[1, 2, 3]", "[3, 2, 1]"},
+      {"[1, 1, 1, 2]", "[2, 1, 1, 1]"},
+      {R"(["a", "b", "c", "a", "b", "b", "a"])",
+       R"(["c", "b", "a", "b", "a", "c"])"},
+      {"[1, 2, 3, 4, 5, 6, 7, 8]", "[0, 2, 4, 9, 6, 8, 10]"},
+      {R"({"a": [1, {"b": [2, 3]}], "c": {}})",
+       R"({"a": [{"b": [3, 2]}, 1], "c": {"d": null}})"},
+      {R"({"x": [[1, 2], [3, 4]]})", R"({"x": [[1, 2, 5], [4], [6]]})"},
+      {"null", R"({"a": 1})"},
+  };
+
+  for (const auto& [from, to] : cases) {
+    SCOPED_TRACE(std::string(from) + " -> " + to);
+    ExpectRoundTrip(parse(from), parse(to));
+  }
+}
+
+TEST(DiffTest, Raw) {
+  const Value from = R"({"a": [1, 2], "b": 3})"_json;
+  EXPECT_THAT(diff(from, object_t{{"a", Raw{"[1, 2]"}}, {"b", 3}}),
+              Eq(array_t{}));
+  EXPECT_THAT(diff(Value(Raw{R"({"a": [1, 2], "b": 4})"}), from),
+              Eq(R"([{"op": "replace", "path": "/b", "value": 3}])"_json));
+
+  Value to = object_t{{"a", Raw{"[1, 3]"}}, {"c", Raw{"{}"}}};
+  Value patched = from;
+  apply_patch(patched, diff(from, to));
+  expand(to);
+  EXPECT_THAT(patched, Eq(to));
+}
+
+TEST(DiffTest, LargeArrayRoundTrip) {
+  Value from = array_t{};
+  Value to = array_t{};
+  for (int32_t i = 0; i < 5000; i++) {
+    from.push_back(i);
+    if (i % 7 != 0) {
+      to.push_back(i % 11 == 0 ? -i : i);
+    }
+  }
+
+  ExpectRoundTrip(from, to);
+}
+
+TEST(DiffTest, DeeplyNested) {
+  // Alternates arrays and objects so that both kinds of frame nest.
+  constexpr size_t kDepth = 300000;
+  auto nest = [](Value& root) {
+    Value* leaf = &root;
+    for (size_t i = 0; i < kDepth; i++) {
+      if (i % 2 == 0) {
+        leaf = &leaf->emplace_back(object_t{});
+      } else {
+        leaf = &(*leaf)["k"];
+        *leaf = array_t{};
+      }
+    }
+
+    return leaf;
+  };
+
+  Value from = array_t{};
+  Value to = array_t{};
+  Value* from_leaf = nest(from);
+  Value* to_leaf = nest(to);
+  from_leaf->emplace_back(1);
+  to_leaf->emplace_back(2);
+
+  Value patch = diff(from, to);
+  ASSERT_THAT(patch.size(), Eq(1u));
+  EXPECT_THAT(patch[0]["op"], Eq("replace"));
+  apply_patch(from, patch);
+  EXPECT_THAT(from, Eq(to));
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,153 @@
+#include "warren/json/utils/document.h"
+
+#include <cstddef>  // size_t
+#include <string>
+#include <string_view>
+#include <utility>  // move
+#include <vector>
+
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/patch.h"
+#include "warren/json/utils/writer.h"
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+bool is_container(const Value& value) {
+  return value.is_array() || value.is_object();
+}
+
+// Newline plus indentation at `depth`, as Writer produces it.
+void indent(const PrintOptions& opts, size_t depth, std::string& out) {
+  if (!opts.compact) {
+    out += '\n';
+    out.append(depth * opts.tab_width, ' ');
+  }
+}
+
+}  // namespace
+
+Value& Document::mutate(std::string_view pointer) {
+  std::vector<Value*> ancestors;
+  Value* node = resolve(root_, pointer, ancestors);
+  if (!node) {
+    throw BadAccessException("unresolvable pointer: " + std::string(pointer));
+  }
+
+  invalidate(*node);
+  for (const Value* ancestor : ancestors) {
+    forget(*ancestor);
+  }
+
+  return *node;
+}
+
+void Document::print(std::string& out, const PrintOptions& opts) {
+  // Canonical output reorders some members, so it is not cached.
+  if (!is_container(root_) || opts.canonical) {
+    Writer(out, opts).value(root_);
+    return;
+  }
+
+  OptionsKey key = {opts.tab_width, opts.trailing_commas, opts.compact,
+                    opts.ascii};
+  emit(caches_[key], opts, root_, 0, out);
+}
+
+std::string Document::to_string(const PrintOptions& opts) {
+  std::string out;
+  print(out, opts);
+  return out;
+}
+
+// Renders a container at `depth` into pieces. Scalars, keys and layout are
+// folded into the literal bytes; container children become references.
+const Document::Entry& Document::entry(Cache& cache, const PrintOptions& opts,
+                                       const Value& node, size_t depth) {
+  if (auto it = cache.find(&node); it != cache.end()) {
+    return it->second;
+  }
+
+  Entry pieces(1);
+  auto child = [&](const Value& value) {
+    if (is_container(value)) {
+      pieces.back().child = &value;
+      pieces.emplace_back();
+    } else {
+      Writer(pieces.back().bytes, opts).value(value);
+    }
+  };
+
+  const bool object = node.is_object();
+  const size_t size = object ? node.items().size() : node.elements().size();
+  std::string* bytes = &pieces.back().bytes;
+  *bytes += object ? '{' : '[';
+  size_t i = 0;
+  for (auto it = node.begin(); it != node.end(); ++it, ++i) {
+    bytes = &pieces.back().bytes;
+    if (i > 0) {
+      *bytes += ',';
+    }
+
+    indent(opts, depth + 1, *bytes);
+    if (object) {
+      Writer(*bytes, opts).value(std::string_view(it.key()));
+      *bytes += opts.compact ? ":" : ": ";
+    }
+
+    child(*it);
+  }
+
+  bytes = &pieces.back().bytes;
+  if (size > 0) {
+    if (opts.trailing_commas) {
+      *bytes += ',';
+    }
+
+    indent(opts, depth, *bytes);
+  }
+
+  *bytes += object ? '}' : ']';
+  return cache.emplace(&node, std::move(pieces)).first->second;
+}
+
+void Document::emit(Cache& cache, const PrintOptions& opts, const Value& node,
+                    size_t depth, std::string& out) {
+  for (const Piece& piece : entry(cache, opts, node, depth)) {
+    out += piece.bytes;
+    if (piece.child) {
+      emit(cache, opts, *piece.child, depth + 1, out);
+    }
+  }
+}
+
+void Document::forget(const Value& node) {
+  for (auto& [key, cache] : caches_) {
+    cache.erase(&node);
+  }
+}
+
+void Document::invalidate(const Value& node) {
+  if (!is_container(node) || caches_.empty()) {
+    return;
+  }
+
+  std::vector<const Value*> pending = {&node};
+  while (!pending.empty()) {
+    const Value* curr = pending.back();
+    pending.pop_back();
+    forget(*curr);
+
+    for (const Value& child : *curr) {
+      if (is_container(child)) {
+        pending.push_back(&child);
+      }
+    }
+  }
+}
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>  // move
+#include <vector>
+
+#include "warren/json/utils/writer.h"
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+// A Value that remembers how its subtrees were serialized, so printing it
+// again after a small change only re-renders the changed path:
+//
+//   Document doc(std::move(snapshot));
+//   doc.to_string();                       // renders and caches everything
+//   doc.mutate("/users/42/name") = "Ada";  // drops the cache along the path
+//   doc.to_string();                       // re-renders /, /users, /users/42
+//
+// The cache is kept per PrintOptions. Each container stores its own bytes
+// once, with references to its container children, so the cache holds about
+// one copy of the output per PrintOptions in use.
+class Document {
+ public:
+  explicit Document(Value root = {}) : root_(std::move(root)) {}
+
+  // The cache is keyed by node addresses in root(), so copies and moves start
+  // with an empty cache.
+  Document(const Document& other) : root_(other.root_) {}
+  Document(Document&& other) noexcept : root_(std::move(other.root_)) {
+    other.caches_.clear();
+  }
+
+  Document& operator=(const Document& other) {
+    if (this != &other) {
+      root_ = other.root_;
+      caches_.clear();
+    }
+
+    return *this;
+  }
+
+  Document& operator=(Document&& other) noexcept {
+    if (this != &other) {
+      root_ = std::move(other.root_);
+      caches_.clear();
+      other.caches_.clear();
+    }
+
+    return *this;
+  }
+
+  const Value& root() const { return root_; }
+
+  // Returns the value at the RFC 6901 `pointer` for modification and drops
+  // the cached output of it, its descendants and its ancestors. The reference
+  // is valid until the next call on the Document. Throws BadAccessException
+  // if the pointer does not resolve.
+  Value& mutate(std::string_view pointer = "");
+
+  // Appends the serialization of root() to `out`; identical to
+  // json::print(root(), out, opts).
+  void print(std::string& out, const PrintOptions& opts = {});
+
+  std::string to_string(const PrintOptions& opts = {});
+
+  void clear_cache() { caches_.clear(); }
+
+ private:
+  // Literal bytes followed by an optional container child, whose own bytes
+  // come from its cache entry.
+  struct Piece {
+    std::string bytes;
+    const Value* child = nullptr;
+  };
+
+  using Entry = std::vector<Piece>;
+
+  using Cache = std::unordered_map<const Value*, Entry>;
+
+  using OptionsKey = std::tuple<size_t, bool, bool, bool>;
+
+  const Entry& entry(Cache& cache, const PrintOptions& opts, const Value& node,
+                     size_t depth);
+
+  void emit(Cache& cache, const PrintOptions& opts, const Value& node,
+            size_t depth, std::string& out);
+
+  // Drops the cached output of `node` alone.
+  void forget(const Value& node);
+
+  // Drops the cached output of `node` and all of its descendants.
+  void invalidate(const Value& node);
+
+  Value root_;
+  std::map<OptionsKey, Cache> caches_;
+};
+
+}  // namespace json
+}  // namespace warren
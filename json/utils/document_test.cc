@@ -0,0 +1,108 @@
+#include "warren/json/utils/document.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/utils/to_string.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::Eq;
+
+const PrintOptions kOptions[] = {
+    PrintOptions{},
+    PrintOptions{.tab_width = 4},
+    PrintOptions{.trailing_commas = true},
+    PrintOptions{.compact = true},
+    PrintOptions{.ascii = true},
+};
+
+void expect_matches(Document& doc) {
+  for (const PrintOptions& opts : kOptions) {
+    EXPECT_THAT(doc.to_string(opts), Eq(to_string(doc.root(), opts)));
+  }
+}
+
+TEST(DocumentTest, MatchesToString) {
+  Document doc(R"({
+    "users": [
+      {"name": "a", "tags": ["x", "y"], "meta": {}},
+      {"name": "bé", "tags": [], "meta": {"k": [1, 2.5, null]}}
+    ],
+    "count": 2,
+    "empty": []
+  })"_json);
+  expect_matches(doc);
+  // Second round comes from the cache.
+  expect_matches(doc);
+
+  EXPECT_THAT(Document().to_string(), Eq("null"));
+  EXPECT_THAT(Document("[]"_json).to_string(), Eq("[]"));
+}
+
+TEST(DocumentTest, ReflectsMutations) {
+  Document doc(R"({"a": [{"b": 1}, {"c": [2]}], "d": {"e": "f"}})"_json);
+  expect_matches(doc);
+
+  doc.mutate("/a/1/c/0") = "changed";
+  expect_matches(doc);
+
+  doc.mutate("/a/0") = array_t{1, 2, 3};
+  expect_matches(doc);
+
+  array_t& a = doc.mutate("/a").elements();
+  a.erase(a.begin());
+  expect_matches(doc);
+
+  doc.mutate("/d")["g"] = object_t{{"h", true}};
+  expect_matches(doc);
+
+  doc.mutate() = "[1]"_json;
+  expect_matches(doc);
+  EXPECT_THAT(doc.to_string(PrintOptions{.compact = true}), Eq("[1]"));
+}
+
+TEST(DocumentTest, EscapedPointers) {
+  Document doc(R"({"a/b": {"c~d": [1]}})"_json);
+  expect_matches(doc);
+  doc.mutate("/a~1b/c~0d/0") = 2;
+  expect_matches(doc);
+  EXPECT_THAT(doc.root(), Eq(R"({"a/b": {"c~d": [2]}})"_json));
+}
+
+TEST(DocumentTest, UnresolvablePointer) {
+  Document doc(R"({"a": 1})"_json);
+  EXPECT_THROW(doc.mutate("/b"), BadAccessException);
+  EXPECT_THROW(doc.mutate("a"), BadAccessException);
+}
+
+TEST(DocumentTest, CopiesDoNotShareCache) {
+  Document doc(R"({"x": [1, 2, 3], "y": {"old": [1, 2, 3]}})"_json);
+  expect_matches(doc);
+
+  Document copy = doc;
+  copy.mutate("/x") = object_t{{"a", array_t{4}}};
+  copy.mutate("/y")["new"] = object_t{{"old", array_t{1, 2, 3}}};
+  expect_matches(copy);
+  expect_matches(doc);
+
+  Document moved = std::move(copy);
+  moved.mutate("/y/new") = false;
+  expect_matches(moved);
+
+  copy = doc;
+  expect_matches(copy);
+  doc = std::move(moved);
+  expect_matches(doc);
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
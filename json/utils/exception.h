@@ -24,10 +24,25 @@ class BadAccessException final : public JsonException {
   using JsonException::JsonException;
 };
 
-// TODO(implement iterators)
 class NonIterableTypeException final : public JsonException {
   using JsonException::JsonException;
 };
 
+class PatchException final : public JsonException {
+  using JsonException::JsonException;
+};
+
+class SchemaException final : public JsonException {
+  using JsonException::JsonException;
+};
+
+class ValidationException final : public JsonException {
+  using JsonException::JsonException;
+};
+
+class WriterException final : public JsonException {
+  using JsonException::JsonException;
+};
+
 }  // namespace json
 }  // namespace warren
@@ -0,0 +1,464 @@
+#include "warren/json/utils/frozen.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <bit>
+#include <cerrno>
+#include <cstddef>  // size_t
+#include <cstdint>  // int32_t, uint8_t, uint32_t, uint64_t
+#include <cstring>  // memcpy
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>  // move
+#include <vector>
+
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/value.h"
+
+namespace {
+
+using warren::json::ParseException;
+
+constexpr std::string_view kMagic = "WJFROZ01";
+constexpr size_t kHeaderSize = 16;
+
+uint64_t to_little_endian(uint64_t n) {
+  if constexpr (std::endian::native == std::endian::big) {
+    return std::byteswap(n);
+  }
+
+  return n;
+}
+
+void put_word(std::string& out, uint64_t n) {
+  n = to_little_endian(n);
+  char bytes[sizeof(n)];
+  std::memcpy(bytes, &n, sizeof(n));
+  out.append(bytes, sizeof(n));
+}
+
+void set_word(std::string& out, size_t offset, uint64_t n) {
+  n = to_little_endian(n);
+  std::memcpy(out.data() + offset, &n, sizeof(n));
+}
+
+void pad(std::string& out) {
+  out.append((8 - out.size() % 8) % 8, '\0');
+}
+
+[[noreturn]] void corrupt(uint64_t offset) {
+  throw ParseException("corrupt frozen document at byte " +
+                       std::to_string(offset));
+}
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+std::string freeze(const Value& value) {
+  std::string out(kMagic);
+  put_word(out, 0);
+
+  // Strings are keyed by views into `value`, which outlives the map.
+  std::unordered_map<std::string_view, uint64_t> strings;
+  auto string = [&out, &strings](std::string_view s) -> uint64_t {
+    auto [it, inserted] = strings.try_emplace(s, out.size());
+    if (inserted) {
+      put_word(out, s.size());
+      out += s;
+      out += '\0';
+      pad(out);
+    }
+
+    return it->second << 8 | FrozenView::kString;
+  };
+
+  // Scalars become references right away. Containers get their node laid
+  // out with zeroed slots, which are filled as their children are written.
+  auto write = [&out, &string](const Value& node) -> uint64_t {
+    if (node.is_null()) {
+      return FrozenView::kNull;
+    } else if (node.is_boolean()) {
+      return bool(node) ? FrozenView::kTrue : FrozenView::kFalse;
+    } else if (node.is_integral()) {
+      uint32_t bits = std::bit_cast<uint32_t>(int32_t(node));
+      return uint64_t(bits) << 8 | FrozenView::kIntegral;
+    } else if (node.is_double()) {
+      uint64_t offset = out.size();
+      put_word(out, std::bit_cast<uint64_t>(double(node)));
+      return offset << 8 | FrozenView::kDouble;
+    } else if (node.is_string()) {
+      return string(static_cast<const std::string&>(node));
+    }
+
+    uint64_t offset = out.size();
+    size_t slots = node.is_object() ? 2 * node.size() : node.size();
+    put_word(out, node.size());
+    out.append(8 * slots, '\0');
+    return offset << 8 | (node.is_object() ? FrozenView::kObject
+                                           : FrozenView::kArray);
+  };
+
+  struct Frame {
+    Value::const_iterator it;
+    Value::const_iterator end;
+    size_t slot;
+    size_t size;
+    bool is_object;
+  };
+
+  // Raw values are parsed and frozen as their tree. The parsed copies stay
+  // alive for the views held in `strings`.
+  std::deque<Value> expanded;
+  auto resolve = [&expanded](const Value& node) -> const Value& {
+    if (!node.is_raw()) {
+      return node;
+    }
+
+    return expanded.emplace_back(parse(node.raw()));
+  };
+
+  std::vector<Frame> stack;
+  const Value& top_level = resolve(value);
+  uint64_t root = write(top_level);
+  set_word(out, kMagic.size(), root);
+  if (top_level.is_array() || top_level.is_object()) {
+    stack.push_back({top_level.begin(), top_level.end(), (root >> 8) + 8,
+                     top_level.size(), top_level.is_object()});
+  }
+
+  while (!stack.empty()) {
+    Frame& top = stack.back();
+    if (top.it == top.end) {
+      stack.pop_back();
+      continue;
+    }
+
+    // std::map keeps keys in byte order, which is the order lookups search.
+    if (top.is_object) {
+      set_word(out, top.slot, string(top.it.key()));
+    }
+
+    const Value& child = resolve(*top.it++);
+    size_t slot = top.is_object ? top.slot + 8 * top.size : top.slot;
+    top.slot += 8;
+    uint64_t ref = write(child);
+    set_word(out, slot, ref);
+    if (child.is_array() || child.is_object()) {
+      stack.push_back({child.begin(), child.end(), (ref >> 8) + 8,
+                       child.size(), child.is_object()});
+    }
+  }
+
+  return out;
+}
+
+FrozenView FrozenView::root(std::string_view data) {
+  if (data.size() < kHeaderSize || !data.starts_with(kMagic)) {
+    throw ParseException("not a frozen document");
+  }
+
+  FrozenView view(data, 0);
+  view.ref_ = view.word(kMagic.size());
+  if (view.tag() > kObject ||
+      (view.tag() >= kDouble &&
+       (view.payload() < kHeaderSize || view.payload() % 8 != 0))) {
+    corrupt(kMagic.size());
+  }
+
+  return view;
+}
+
+template <>
+std::optional<bool> FrozenView::try_get<bool>() const {
+  if (!is_boolean()) {
+    return std::nullopt;
+  }
+
+  return tag() == kTrue;
+}
+
+template <>
+std::optional<int32_t> FrozenView::try_get<int32_t>() const {
+  if (!is_integral()) {
+    return std::nullopt;
+  }
+
+  return std::bit_cast<int32_t>(static_cast<uint32_t>(payload()));
+}
+
+template <>
+std::optional<double> FrozenView::try_get<double>() const {
+  if (!is_double()) {
+    return std::nullopt;
+  }
+
+  return std::bit_cast<double>(word(payload()));
+}
+
+template <>
+std::optional<std::string_view> FrozenView::try_get<std::string_view>()
+    const {
+  if (!is_string()) {
+    return std::nullopt;
+  }
+
+  uint64_t length = word(payload());
+  uint64_t start = payload() + 8;
+  if (length > data_.size() - start) {
+    corrupt(payload());
+  }
+
+  return data_.substr(start, length);
+}
+
+bool FrozenView::as_bool() const {
+  if (!is_boolean()) {
+    assert_tag(kTrue);
+  }
+
+  return tag() == kTrue;
+}
+
+int32_t FrozenView::as_int() const {
+  assert_tag(kIntegral);
+  return *try_get<int32_t>();
+}
+
+double FrozenView::as_double() const {
+  assert_tag(kDouble);
+  return *try_get<double>();
+}
+
+std::string_view FrozenView::as_string() const {
+  assert_tag(kString);
+  return *try_get<std::string_view>();
+}
+
+size_t FrozenView::size() const {
+  if (!is_array() && !is_object()) {
+    throw BadAccessException("expected container type (array, object)");
+  }
+
+  return count();
+}
+
+FrozenView FrozenView::operator[](size_t i) const {
+  size_t n = size();
+  if (i >= n) {
+    throw std::out_of_range("index out of range: " + std::to_string(i));
+  }
+
+  return child(payload() + 8 * (1 + (is_object() ? n : 0) + i));
+}
+
+std::string_view FrozenView::key(size_t i) const {
+  assert_tag(kObject);
+  if (i >= count()) {
+    throw std::out_of_range("index out of range: " + std::to_string(i));
+  }
+
+  uint64_t slot = payload() + 8 * (1 + i);
+  FrozenView key = child(slot);
+  if (!key.is_string()) {
+    corrupt(slot);
+  }
+
+  return key.as_string();
+}
+
+std::optional<FrozenView> FrozenView::find(std::string_view key) const {
+  if (!is_object()) {
+    return std::nullopt;
+  }
+
+  size_t lo = 0;
+  size_t hi = count();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    int cmp = this->key(mid).compare(key);
+    if (cmp == 0) {
+      return (*this)[mid];
+    } else if (cmp < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return std::nullopt;
+}
+
+FrozenView FrozenView::at(std::string_view key) const {
+  assert_tag(kObject);
+  if (std::optional<FrozenView> value = find(key)) {
+    return *value;
+  }
+
+  throw std::out_of_range("key not found: " + std::string(key));
+}
+
+Value FrozenView::thaw() const {
+  auto scalar = [](const FrozenView& view) -> Value {
+    switch (view.tag()) {
+      case kNull:
+        return nullptr;
+      case kFalse:
+      case kTrue:
+        return view.as_bool();
+      case kIntegral:
+        return view.as_int();
+      case kDouble:
+        return view.as_double();
+      case kString:
+        return std::string(view.as_string());
+      case kArray:
+        return array_t();
+      default:
+        return object_t();
+    }
+  };
+
+  struct Frame {
+    FrozenView view;
+    Value* target;
+    size_t next;
+  };
+
+  // freeze writes every value but the root into a slot of its own, so a
+  // document yields at most one value per 8 bytes. Slots sharing a container
+  // could otherwise make a small file thaw into an exponentially large tree.
+  size_t budget = data_.size() / 8;
+  Value root = scalar(*this);
+  std::vector<Frame> stack;
+  if (is_array() || is_object()) {
+    stack.push_back({*this, &root, 0});
+  }
+
+  while (!stack.empty()) {
+    Frame& top = stack.back();
+    if (top.next == top.view.count()) {
+      stack.pop_back();
+      continue;
+    }
+
+    size_t i = top.next++;
+    if (budget-- == 0) {
+      corrupt(top.view.payload());
+    }
+
+    FrozenView child = top.view[i];
+    Value* slot;
+    if (top.view.is_array()) {
+      array_t& array = *top.target;
+      if (array.empty()) {
+        array.reserve(top.view.count());
+      }
+
+      slot = &array.emplace_back(scalar(child));
+    } else {
+      object_t& object = *top.target;
+      slot = &object.emplace_hint(object.end(), top.view.key(i),
+                                  scalar(child))->second;
+    }
+
+    if (child.is_array() || child.is_object()) {
+      stack.push_back({child, slot, 0});
+    }
+  }
+
+  return root;
+}
+
+void FrozenView::assert_tag(uint8_t tag) const {
+  static constexpr const char* kNames[] = {
+      "null",   "boolean", "boolean", "integral",
+      "double", "string",  "array",   "object"};
+  if (this->tag() != tag) {
+    throw BadAccessException(std::string("expected type ") + kNames[tag] +
+                             ", got " + kNames[this->tag()]);
+  }
+}
+
+uint64_t FrozenView::word(uint64_t offset) const {
+  if (offset > data_.size() || data_.size() - offset < 8) {
+    corrupt(offset);
+  }
+
+  uint64_t n;
+  std::memcpy(&n, data_.data() + offset, sizeof(n));
+  return to_little_endian(n);
+}
+
+size_t FrozenView::count() const {
+  uint64_t n = word(payload());
+  uint64_t slots = (data_.size() - payload()) / 8 - 1;
+  if (n > (is_object() ? slots / 2 : slots)) {
+    corrupt(payload());
+  }
+
+  return static_cast<size_t>(n);
+}
+
+FrozenView FrozenView::child(uint64_t offset) const {
+  FrozenView view(data_, word(offset));
+  // Containers and doubles are written after the container holding them,
+  // so a reference that doesn't point past this node is corrupt, and may
+  // form a cycle. Strings are shared and can point back, just not into the
+  // header.
+  uint64_t min = view.tag() == kString ? kHeaderSize : payload() + 8;
+  if (view.tag() > kObject ||
+      (view.tag() >= kDouble &&
+       (view.payload() < min || view.payload() % 8 != 0))) {
+    corrupt(offset);
+  }
+
+  return view;
+}
+
+MappedFile::MappedFile(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) < 0) {
+    int err = errno;
+    ::close(fd);
+    throw std::system_error(err, std::generic_category(), path);
+  }
+
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ > 0) {
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), path);
+    }
+
+    data_ = static_cast<const char*>(addr);
+  }
+
+  ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+}  // namespace json
+}  // namespace warren
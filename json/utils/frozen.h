@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // int32_t, uint64_t
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+// A frozen document is a Value serialized into one position-independent
+// buffer that is queried in place: write it to a file once, then map it with
+// MappedFile in every process that needs it. There is no parse step, and
+// processes mapping the same file share its pages.
+//
+// Every node is reached through a 64-bit reference whose low byte is the
+// type. Null, booleans and integrals live in the reference itself; the rest
+// point at an 8-byte aligned node holding a double, a length-prefixed string,
+// an array's element references, or an object's sorted key references
+// followed by its value references. Equal strings are stored once.
+std::string freeze(const Value& value);
+
+// Read-only view of a node in a frozen buffer, which must outlive it. Views
+// are two words and cheap to copy. Accessors mirror Value's: a type mismatch
+// throws BadAccessException, a missing key std::out_of_range, and offsets
+// running outside the buffer ParseException, so a corrupt file cannot cause
+// reads out of bounds.
+class FrozenView {
+ public:
+  // The root of `data`. Throws ParseException if it is not a frozen document.
+  static FrozenView root(std::string_view data);
+
+  bool is_null() const noexcept { return tag() == kNull; }
+
+  bool is_boolean() const noexcept {
+    return tag() == kFalse || tag() == kTrue;
+  }
+
+  bool is_number() const noexcept { return is_integral() || is_double(); }
+
+  bool is_integral() const noexcept { return tag() == kIntegral; }
+
+  bool is_double() const noexcept { return tag() == kDouble; }
+
+  bool is_string() const noexcept { return tag() == kString; }
+
+  bool is_array() const noexcept { return tag() == kArray; }
+
+  bool is_object() const noexcept { return tag() == kObject; }
+
+  // Supports bool, int32_t, double and std::string_view (into the buffer).
+  template <typename T>
+  std::optional<T> try_get() const;
+
+  bool as_bool() const;
+  int32_t as_int() const;
+  double as_double() const;
+  std::string_view as_string() const;
+
+  // Arrays and objects. Object members are ordered by key bytes, and
+  // operator[] on an object returns the value of the i-th member.
+  size_t size() const;
+  FrozenView operator[](size_t i) const;
+  std::string_view key(size_t i) const;
+
+  // Binary search over the sorted keys. Returns nullopt if this is not an
+  // object or `key` is absent.
+  std::optional<FrozenView> find(std::string_view key) const;
+  FrozenView at(std::string_view key) const;
+
+  // Copies the subtree out into a Value.
+  Value thaw() const;
+
+ private:
+  static constexpr uint8_t kNull = 0;
+  static constexpr uint8_t kFalse = 1;
+  static constexpr uint8_t kTrue = 2;
+  static constexpr uint8_t kIntegral = 3;
+  static constexpr uint8_t kDouble = 4;
+  static constexpr uint8_t kString = 5;
+  static constexpr uint8_t kArray = 6;
+  static constexpr uint8_t kObject = 7;
+
+  friend std::string freeze(const Value& value);
+
+  FrozenView(std::string_view data, uint64_t ref) : data_(data), ref_(ref) {}
+
+  uint8_t tag() const noexcept { return static_cast<uint8_t>(ref_); }
+
+  uint64_t payload() const noexcept { return ref_ >> 8; }
+
+  void assert_tag(uint8_t tag) const;
+
+  // Reads the little-endian word at `offset`, checking it is in bounds.
+  uint64_t word(uint64_t offset) const;
+
+  // Element count of a container, checked against the buffer size.
+  size_t count() const;
+
+  FrozenView child(uint64_t offset) const;
+
+  std::string_view data_;
+  uint64_t ref_;
+};
+
+template <>
+std::optional<bool> FrozenView::try_get<bool>() const;
+template <>
+std::optional<int32_t> FrozenView::try_get<int32_t>() const;
+template <>
+std::optional<double> FrozenView::try_get<double>() const;
+template <>
+std::optional<std::string_view> FrozenView::try_get<std::string_view>() const;
+
+// A read-only shared mapping of a whole file. Throws std::system_error if the
+// file cannot be opened or mapped.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  std::string_view data() const noexcept { return {data_, size_}; }
+
+  FrozenView root() const { return FrozenView::root(data()); }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,194 @@
+#include "warren/json/utils/frozen.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::Eq;
+using ::testing::Optional;
+
+const Value kDocument = R"({
+  "name": "reference",
+  "version": 3,
+  "ratio": -0.25,
+  "enabled": true,
+  "missing": null,
+  "cities": [
+    {"name": "Oslo", "population": 709037, "tags": ["capital", "port"]},
+    {"name": "Bergen", "population": 291940, "tags": ["port"]},
+    {"name": "Tromsø", "population": 78745, "tags": []}
+  ],
+  "empty": {}
+})"_json;
+
+TEST(FrozenTest, Scalars) {
+  EXPECT_TRUE(FrozenView::root(freeze(nullptr)).is_null());
+  EXPECT_TRUE(FrozenView::root(freeze(false)).is_boolean());
+  EXPECT_FALSE(FrozenView::root(freeze(false)).as_bool());
+  EXPECT_THAT(FrozenView::root(freeze(-7)).as_int(), Eq(-7));
+  EXPECT_THAT(FrozenView::root(freeze(1.5)).as_double(), Eq(1.5));
+  EXPECT_THAT(FrozenView::root(freeze("abc")).as_string(), Eq("abc"));
+  EXPECT_THAT(FrozenView::root(freeze(1)).try_get<int32_t>(), Optional(1));
+  EXPECT_THAT(FrozenView::root(freeze(1)).try_get<double>(), Eq(std::nullopt));
+}
+
+TEST(FrozenTest, Lookup) {
+  const std::string data = freeze(kDocument);
+  const FrozenView root = FrozenView::root(data);
+
+  ASSERT_TRUE(root.is_object());
+  EXPECT_THAT(root.size(), Eq(7u));
+  EXPECT_THAT(root.key(0), Eq("cities"));
+  EXPECT_THAT(root.at("name").as_string(), Eq("reference"));
+  EXPECT_THAT(root.at("version").as_int(), Eq(3));
+  EXPECT_THAT(root.at("ratio").as_double(), Eq(-0.25));
+  EXPECT_TRUE(root.at("enabled").as_bool());
+  EXPECT_TRUE(root.at("missing").is_null());
+  EXPECT_TRUE(root.at("empty").is_object());
+  EXPECT_THAT(root.at("empty").size(), Eq(0u));
+  EXPECT_THAT(root.find("absent"), Eq(std::nullopt));
+  EXPECT_THROW(root.at("absent"), std::out_of_range);
+
+  const FrozenView cities = root.at("cities");
+  ASSERT_THAT(cities.size(), Eq(3u));
+  EXPECT_THAT(cities[2].at("name").as_string(), Eq("Tromsø"));
+  EXPECT_THAT(cities[1].at("population").as_int(), Eq(291940));
+  EXPECT_THAT(cities[0].at("tags")[1].as_string(), Eq("port"));
+  EXPECT_THROW(cities[3], std::out_of_range);
+  EXPECT_THROW(cities.at("name"), BadAccessException);
+  EXPECT_THROW(root.at("name").as_int(), BadAccessException);
+}
+
+TEST(FrozenTest, Thaw) {
+  EXPECT_THAT(FrozenView::root(freeze(kDocument)).thaw(), Eq(kDocument));
+  EXPECT_THAT(FrozenView::root(freeze(kDocument)).at("cities")[0].thaw(),
+              Eq(kDocument.at("cities")[0]));
+
+  Value deep = 1;
+  for (int i = 0; i < 10000; i++) {
+    object_t wrapper;
+    wrapper.emplace("k", std::move(deep));
+    deep = std::move(wrapper);
+  }
+
+  EXPECT_THAT(FrozenView::root(freeze(deep)).thaw(), Eq(deep));
+}
+
+TEST(FrozenTest, StringsAreStoredOnce) {
+  array_t records;
+  for (int i = 0; i < 100; i++) {
+    records.push_back(R"({"country": "Norway", "currency": "NOK"})"_json);
+  }
+
+  EXPECT_LT(freeze(records).size(), 6400u);
+}
+
+TEST(FrozenTest, Raw) {
+  const Value value = array_t{Raw{R"({"a": [1, "b"]})"}};
+  EXPECT_THAT(FrozenView::root(freeze(value)).thaw(),
+              Eq(R"([{"a": [1, "b"]}])"_json));
+}
+
+TEST(FrozenTest, Corrupt) {
+  EXPECT_THROW(FrozenView::root(""), ParseException);
+  EXPECT_THROW(FrozenView::root("{\"a\": 1}........"), ParseException);
+
+  std::string data = freeze(kDocument);
+  EXPECT_THROW(FrozenView::root(std::string_view(data).substr(0, 16)).size(),
+               ParseException);
+
+  // Point the root at an offset past the end.
+  data[8 + 1] = '\xff';
+  data[8 + 2] = '\xff';
+  EXPECT_THROW(FrozenView::root(data).size(), ParseException);
+}
+
+TEST(FrozenTest, CorruptReferences) {
+  // The outer array is at byte 16 with its slot at 24, the inner one at byte
+  // 32 with its slot at 40.
+  const std::string data = freeze(R"([[1]])"_json);
+  ASSERT_THAT(data.size(), Eq(48u));
+  auto point = [&data](size_t slot, char offset) {
+    std::string res = data;
+    res.replace(slot, 8, std::string("\x06", 1) + offset + std::string(6, 0));
+    return res;
+  };
+
+  // The inner array holding the outer one or itself would never end.
+  EXPECT_THROW(FrozenView::root(point(40, 16)).thaw(), ParseException);
+  EXPECT_THROW(FrozenView::root(point(40, 32)).thaw(), ParseException);
+  EXPECT_THROW(FrozenView::root(point(24, 33)).thaw(), ParseException);
+  EXPECT_THROW(FrozenView::root(point(8, 0)).thaw(), ParseException);
+  EXPECT_THAT(FrozenView::root(point(24, 32)).thaw(), Eq(R"([[1]])"_json));
+}
+
+TEST(FrozenTest, SharedContainers) {
+  // Forty arrays, each with both of its slots pointing at the next one, so
+  // every level doubles the tree.
+  std::string data = "WJFROZ01";
+  auto word = [&data](uint64_t n) {
+    for (int i = 0; i < 8; i++) {
+      data += static_cast<char>(n >> (8 * i));
+    }
+  };
+
+  constexpr uint64_t kArray = 6;
+  word(16 << 8 | kArray);
+  for (uint64_t i = 0; i < 40; i++) {
+    uint64_t next = 16 + 24 * (i + 1);
+    word(2);
+    word(next << 8 | kArray);
+    word(next << 8 | kArray);
+  }
+
+  word(0);
+  EXPECT_THAT(FrozenView::root(data)[0][1][0].size(), Eq(2u));
+  EXPECT_THROW(FrozenView::root(data).thaw(), ParseException);
+}
+
+TEST(FrozenTest, CorruptKey) {
+  std::string data = freeze(R"({"a": 1})"_json);
+  // The key slot follows the object's count word at byte 16.
+  data.replace(24, 8, std::string("\x03", 1) + std::string(7, 0));
+  EXPECT_THROW(FrozenView::root(data).key(0), ParseException);
+  EXPECT_THROW(FrozenView::root(data).thaw(), ParseException);
+}
+
+TEST(FrozenTest, MappedFile) {
+  char path[] = "/tmp/frozen_test_XXXXXX";
+  int fd = ::mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ::close(fd);
+  std::ofstream(path, std::ios::binary) << freeze(kDocument);
+
+  {
+    MappedFile file(path);
+    EXPECT_THAT(file.root().at("cities")[1].at("name").as_string(),
+                Eq("Bergen"));
+    EXPECT_THAT(file.root().thaw(), Eq(kDocument));
+  }
+
+  std::remove(path);
+  EXPECT_THROW(MappedFile file(path), std::system_error);
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
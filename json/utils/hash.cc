@@ -0,0 +1,191 @@
+#include "warren/json/utils/hash.h"
+
+#include <cstddef>  // size_t
+#include <cstdint>  // int32_t, uint64_t
+#include <cstring>  // memcpy
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "warren/json/value.h"
+
+namespace {
+
+constexpr uint64_t kNull = 0x9e3779b97f4a7c15;
+constexpr uint64_t kFalse = 0xbf58476d1ce4e5b9;
+constexpr uint64_t kTrue = 0x94d049bb133111eb;
+constexpr uint64_t kNumber = 0xd6e8feb86659fd93;
+constexpr uint64_t kString = 0xa0761d6478bd642f;
+constexpr uint64_t kArray = 0xe7037ed1a0b428db;
+constexpr uint64_t kObject = 0x8ebc6af09c88c6e3;
+constexpr uint64_t kRaw = 0x2d358dccaa6c78a5;
+
+// MurmurHash3's 64-bit finalizer.
+uint64_t fmix(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccd;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53;
+  h ^= h >> 33;
+
+  return h;
+}
+
+uint64_t hash_bytes(const std::string& s, uint64_t seed) {
+  uint64_t h = fmix(seed ^ kString ^ s.size());
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= s.size(); i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, s.data() + i, sizeof(word));
+    h = fmix(h ^ word);
+  }
+
+  if (i < s.size()) {
+    uint64_t word = 0;
+    std::memcpy(&word, s.data() + i, s.size() - i);
+    h = fmix(h ^ word);
+  }
+
+  return h;
+}
+
+uint64_t hash_number(double d, uint64_t seed) {
+  // -0.0 == 0.0
+  if (d == 0) {
+    d = 0;
+  }
+
+  uint64_t bits;
+  std::memcpy(&bits, &d, sizeof(bits));
+
+  return fmix(seed ^ kNumber ^ bits);
+}
+
+// A container being hashed. Arrays fold their children in order; objects sum
+// per-member hashes so that member order does not matter.
+struct Frame {
+  const warren::json::Value* value = nullptr;
+  const warren::json::array_t* array = nullptr;
+  const warren::json::object_t* object = nullptr;
+  size_t index = 0;
+  warren::json::object_t::const_iterator member = {};
+  uint64_t acc = 0;
+
+  bool done() const {
+    return array ? index == array->size() : member == object->end();
+  }
+
+  const warren::json::Value& child() const {
+    return array ? (*array)[index] : member->second;
+  }
+
+  void fold(uint64_t child, uint64_t seed) {
+    if (array) {
+      acc = fmix(acc ^ child) + index++;
+    } else {
+      acc += fmix(hash_bytes(member->first, seed) ^ child);
+      ++member;
+    }
+  }
+
+  uint64_t finish(uint64_t seed) const {
+    return array ? fmix(seed ^ kArray ^ acc ^ array->size())
+                 : fmix(seed ^ kObject ^ acc ^ object->size());
+  }
+};
+
+// Returns the hash of a leaf or empty container, or pushes a frame for a
+// non-empty container and returns nullopt.
+std::optional<uint64_t> enter(const warren::json::Value& value, uint64_t seed,
+                              std::vector<Frame>& stack) {
+  if (value.is_raw()) {
+    return fmix(hash_bytes(value.raw(), seed) ^ kRaw);
+  }
+
+  return value.visit(
+      [&]() -> std::optional<uint64_t> { return fmix(seed ^ kNull); },
+      [&](bool b) -> std::optional<uint64_t> {
+        return fmix(seed ^ (b ? kTrue : kFalse));
+      },
+      [&](int32_t i) -> std::optional<uint64_t> {
+        return hash_number(i, seed);
+      },
+      [&](double d) -> std::optional<uint64_t> {
+        return hash_number(d, seed);
+      },
+      [&](const std::string& s) -> std::optional<uint64_t> {
+        return hash_bytes(s, seed);
+      },
+      [&](const warren::json::array_t& a) -> std::optional<uint64_t> {
+        Frame frame{.value = &value, .array = &a};
+        if (a.empty()) {
+          return frame.finish(seed);
+        }
+
+        stack.push_back(frame);
+        return std::nullopt;
+      },
+      [&](const warren::json::object_t& o) -> std::optional<uint64_t> {
+        Frame frame{.value = &value, .object = &o, .member = o.begin()};
+        if (o.empty()) {
+          return frame.finish(seed);
+        }
+
+        stack.push_back(frame);
+        return std::nullopt;
+      });
+}
+
+// Hashes `value` bottom-up, recording the hash of each non-empty container
+// in `containers` if given.
+uint64_t walk(
+    const warren::json::Value& value,
+    std::unordered_map<const warren::json::Value*, uint64_t>* containers,
+    uint64_t seed) {
+  std::vector<Frame> stack;
+  if (std::optional<uint64_t> h = enter(value, seed, stack)) {
+    return *h;
+  }
+
+  while (true) {
+    if (!stack.back().done()) {
+      const warren::json::Value& child = stack.back().child();
+      if (std::optional<uint64_t> h = enter(child, seed, stack)) {
+        stack.back().fold(*h, seed);
+      }
+
+      continue;
+    }
+
+    uint64_t h = stack.back().finish(seed);
+    if (containers) {
+      (*containers)[stack.back().value] = h;
+    }
+
+    stack.pop_back();
+    if (stack.empty()) {
+      return h;
+    }
+
+    stack.back().fold(h, seed);
+  }
+}
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+uint64_t hash(const Value& value, uint64_t seed) {
+  return walk(value, nullptr, seed);
+}
+
+uint64_t hash(const Value& value,
+              std::unordered_map<const Value*, uint64_t>& containers,
+              uint64_t seed) {
+  return walk(value, &containers, seed);
+}
+
+}  // namespace json
+}  // namespace warren
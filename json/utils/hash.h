@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint64_t
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+// Structural hash: values that compare equal hash equally, so an integral and
+// a double holding the same number share a hash. Object members are combined
+// order-independently. Runs in bounded stack depth.
+uint64_t hash(const Value& value, uint64_t seed = 0);
+
+// Also records the hash of every non-empty array and object in `value`,
+// `value` included, so that callers comparing subtrees hash each one once.
+uint64_t hash(const Value& value,
+              std::unordered_map<const Value*, uint64_t>& containers,
+              uint64_t seed = 0);
+
+struct Hash {
+  size_t operator()(const Value& value) const { return hash(value); }
+};
+
+// An immutable value paired with its hash, for dedup sets and caches that
+// compare the same documents repeatedly. Equality checks the hashes first and
+// only walks the trees when they match.
+//
+// Values with different seeds but equal content compare equal, so equality
+// and std::hash use the unseeded hash, computed alongside the seeded one when
+// `seed` is not 0.
+//
+// `Value` itself does not cache hashes: references handed out by
+// `operator[]`, the iterators and the container conversions let callers
+// mutate a subtree without its ancestors knowing.
+class HashedValue {
+ public:
+  explicit HashedValue(Value value, uint64_t seed = 0)
+      : value_(std::move(value)),
+        seed_(seed),
+        hash_(json::hash(value_, seed)),
+        unseeded_(seed == 0 ? hash_ : json::hash(value_)) {}
+
+  const Value& value() const noexcept { return value_; }
+
+  uint64_t seed() const noexcept { return seed_; }
+
+  uint64_t hash() const noexcept { return hash_; }
+
+  bool operator==(const HashedValue& other) const {
+    return unseeded_ == other.unseeded_ && value_ == other.value_;
+  }
+
+ private:
+  friend struct std::hash<HashedValue>;
+
+  Value value_;
+  uint64_t seed_;
+  uint64_t hash_;
+  uint64_t unseeded_;
+};
+
+}  // namespace json
+}  // namespace warren
+
+template <>
+struct std::hash<warren::json::HashedValue> {
+  size_t operator()(const warren::json::HashedValue& value) const noexcept {
+    return value.unseeded_;
+  }
+};
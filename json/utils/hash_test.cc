@@ -0,0 +1,105 @@
+#include "warren/json/utils/hash.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/utils/parse.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ne;
+
+TEST(HashTest, EqualValuesHashEqually) {
+  EXPECT_THAT(hash(R"({"a": [1, 2.5, null], "b": {"c": true}})"_json),
+              Eq(hash(R"({"b": {"c": true}, "a": [1, 2.5, null]})"_json)));
+  EXPECT_THAT(hash(Value(1)), Eq(hash(Value(1.0))));
+  EXPECT_THAT(hash(Value(0.0)), Eq(hash(Value(-0.0))));
+}
+
+TEST(HashTest, DistinguishesValues) {
+  EXPECT_THAT(hash("[1, 2]"_json), Ne(hash("[2, 1]"_json)));
+  EXPECT_THAT(hash("[]"_json), Ne(hash("{}"_json)));
+  EXPECT_THAT(hash("[]"_json), Ne(hash("null"_json)));
+  EXPECT_THAT(hash("true"_json), Ne(hash("false"_json)));
+  EXPECT_THAT(hash(R"("1")"_json), Ne(hash("1"_json)));
+  EXPECT_THAT(hash(R"({"a": 1})"_json), Ne(hash(R"({"b": 1})"_json)));
+  EXPECT_THAT(hash(R"({"a": 1})"_json), Ne(hash(R"({"a": 2})"_json)));
+  EXPECT_THAT(hash(R"("abcdefgh")"_json), Ne(hash(R"("abcdefgi")"_json)));
+  EXPECT_THAT(hash("[[1], 2]"_json), Ne(hash("[1, [2]]"_json)));
+}
+
+TEST(HashTest, Raw) {
+  EXPECT_THAT(hash(Value(Raw{"[1]"})), Eq(hash(Value(Raw{"[1]"}))));
+  EXPECT_THAT(hash(Value(Raw{"[1]"})), Ne(hash(Value(Raw{"[2]"}))));
+  EXPECT_THAT(hash(Value(Raw{"\"a\""})), Ne(hash(Value("\"a\""))));
+}
+
+TEST(HashTest, Seed) {
+  Value value = R"({"a": [1, "two"]})"_json;
+  EXPECT_THAT(hash(value, 1), Eq(hash(value, 1)));
+  EXPECT_THAT(hash(value, 1), Ne(hash(value, 2)));
+}
+
+TEST(HashTest, DeeplyNested) {
+  Value root;
+  Value* curr = &root;
+  for (size_t i = 0; i < 1'000'000; i++) {
+    curr = &curr->emplace_back();
+  }
+
+  EXPECT_THAT(hash(root), Eq(hash(Value(root))));
+}
+
+TEST(HashTest, RecordsContainers) {
+  const Value value = R"({"a": [1, {"b": []}], "c": "d"})"_json;
+  std::unordered_map<const Value*, uint64_t> containers;
+  EXPECT_THAT(hash(value, containers, 3), Eq(hash(value, 3)));
+  EXPECT_THAT(containers.size(), Eq(3));
+  EXPECT_THAT(containers[&value], Eq(hash(value, 3)));
+  const Value& a = *value.find("a");
+  EXPECT_THAT(containers[&a], Eq(hash(a, 3)));
+  EXPECT_THAT(containers[&a[1]], Eq(hash(a[1], 3)));
+}
+
+TEST(HashTest, HashedValueDedup) {
+  std::unordered_set<HashedValue> seen;
+  EXPECT_TRUE(seen.insert(HashedValue(R"({"id": 1, "tags": ["a"]})"_json))
+                  .second);
+  EXPECT_FALSE(seen.insert(HashedValue(R"({"tags": ["a"], "id": 1})"_json))
+                   .second);
+  EXPECT_TRUE(seen.insert(HashedValue(R"({"id": 2, "tags": ["a"]})"_json))
+                  .second);
+  EXPECT_THAT(seen.size(), Eq(2));
+}
+
+TEST(HashTest, HashedValueSeeds) {
+  Value value = R"({"a": [1, "two"]})"_json;
+  EXPECT_TRUE(HashedValue(value, 1) == HashedValue(value, 2));
+  EXPECT_FALSE(HashedValue(value, 1) == HashedValue("[1]"_json, 2));
+  EXPECT_FALSE(HashedValue(value, 1) == HashedValue("[1]"_json, 1));
+
+  // Equal keys hash equally across seeds, so lookups find them.
+  std::unordered_set<HashedValue> seen = {HashedValue(value, 1)};
+  EXPECT_FALSE(seen.insert(HashedValue(value, 2)).second);
+  EXPECT_FALSE(seen.insert(HashedValue(value)).second);
+  EXPECT_TRUE(seen.contains(HashedValue(value, 7)));
+  EXPECT_TRUE(seen.insert(HashedValue("[1]"_json, 2)).second);
+  EXPECT_THAT(seen.size(), Eq(2));
+}
+
+TEST(HashTest, Hasher) {
+  std::unordered_set<Value, Hash> values = {"[1]"_json, "[1.0]"_json,
+                                            "{}"_json};
+  EXPECT_THAT(values.size(), Eq(2));
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,740 @@
+#include "warren/json/utils/json_path.h"
+
+#include <cctype>    // isalpha, isdigit, isxdigit, tolower
+#include <charconv>  // from_chars
+#include <cstddef>   // size_t
+#include <cstdint>   // int32_t, int64_t, uint32_t
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "warren/json/parse/utf8.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+// `@.a[0]` or `$['b']` inside a filter.
+struct SingularQuery {
+  bool absolute = false;
+  std::vector<std::variant<std::string, int64_t>> steps = {};
+};
+
+enum class SelectorKind { NAME, WILDCARD, INDEX, SLICE, FILTER };
+
+struct Selector {
+  SelectorKind kind;
+  std::string name = {};
+  int64_t index = 0;
+  std::optional<int64_t> start = {};
+  std::optional<int64_t> end = {};
+  int64_t step = 1;
+  size_t filter = 0;
+};
+
+enum class ExprKind { OR, AND, NOT, EXISTS, COMPARE };
+
+enum class CompareOp { EQ, NE, LT, LE, GT, GE };
+
+struct Operand {
+  std::optional<SingularQuery> query = {};
+  Value literal = {};
+};
+
+std::optional<double> to_double(const Value& value) {
+  if (std::optional<int32_t> i = value.try_get<int32_t>()) {
+    return *i;
+  }
+
+  return value.try_get<double>();
+}
+
+// Results point into the queried document, which a parsed Raw value is not
+// part of.
+void reject_raw(const Value& node) {
+  if (node.is_raw()) {
+    throw BadAccessException("raw value must be expanded for JSONPath");
+  }
+}
+
+size_t normalize(int64_t i, size_t size) {
+  return size_t(i >= 0 ? i : int64_t(size) + i);
+}
+
+const Value* child(const Value& node,
+                   const std::variant<std::string, int64_t>& step) {
+  reject_raw(node);
+  if (const std::string* name = std::get_if<std::string>(&step)) {
+    return node.find(*name);
+  }
+
+  const array_t* array = node.get_if<array_t>();
+  if (!array) {
+    return nullptr;
+  }
+
+  int64_t i = std::get<int64_t>(step);
+  if (i < -int64_t(array->size()) || i >= int64_t(array->size())) {
+    return nullptr;
+  }
+
+  return &(*array)[normalize(i, array->size())];
+}
+
+const Value* resolve(const SingularQuery& query, const Value& root,
+                     const Value& current) {
+  const Value* node = query.absolute ? &root : &current;
+  for (const auto& step : query.steps) {
+    if (!node) {
+      return nullptr;
+    }
+
+    node = child(*node, step);
+  }
+
+  return node;
+}
+
+// RFC 9535 2.3.5.2.2: a missing operand only equals another missing operand,
+// and `<` is only defined between two numbers or two strings.
+bool equal(const Value* lhs, const Value* rhs) {
+  if (!lhs || !rhs) {
+    return lhs == rhs;
+  }
+
+  reject_raw(*lhs);
+  reject_raw(*rhs);
+
+  std::optional<double> l = to_double(*lhs);
+  std::optional<double> r = to_double(*rhs);
+  if (l && r) {
+    return *l == *r;
+  }
+
+  return *lhs == *rhs;
+}
+
+bool less(const Value* lhs, const Value* rhs) {
+  if (!lhs || !rhs) {
+    return false;
+  }
+
+  reject_raw(*lhs);
+  reject_raw(*rhs);
+
+  std::optional<double> l = to_double(*lhs);
+  std::optional<double> r = to_double(*rhs);
+  if (l && r) {
+    return *l < *r;
+  }
+
+  const std::string* ls = lhs->get_if<std::string>();
+  const std::string* rs = rhs->get_if<std::string>();
+  return ls && rs && *ls < *rs;
+}
+
+}  // namespace
+
+struct JsonPath::Segment {
+  bool descendant = false;
+  std::vector<Selector> selectors;
+};
+
+struct JsonPath::Expr {
+  ExprKind kind;
+  size_t lhs = 0;
+  size_t rhs = 0;
+  CompareOp op = CompareOp::EQ;
+  Operand left = {};
+  Operand right = {};
+};
+
+class JsonPath::Compiler {
+ public:
+  Compiler(std::string_view expression, JsonPath& path)
+      : expression_(expression), path_(path) {}
+
+  void compile() {
+    skip_whitespace();
+    expect('$');
+    while (true) {
+      skip_whitespace();
+      if (eof()) {
+        return;
+      }
+
+      path_.segments_.push_back(parse_segment());
+    }
+  }
+
+ private:
+  Segment parse_segment() {
+    Segment segment;
+    if (consume("..")) {
+      segment.descendant = true;
+      if (peek() == '[') {
+        segment.selectors = parse_brackets();
+      } else if (consume('*')) {
+        segment.selectors.push_back(Selector{.kind = SelectorKind::WILDCARD});
+      } else {
+        segment.selectors.push_back(
+            Selector{.kind = SelectorKind::NAME, .name = parse_shorthand()});
+      }
+    } else if (consume('.')) {
+      if (consume('*')) {
+        segment.selectors.push_back(Selector{.kind = SelectorKind::WILDCARD});
+      } else {
+        segment.selectors.push_back(
+            Selector{.kind = SelectorKind::NAME, .name = parse_shorthand()});
+      }
+    } else if (peek() == '[') {
+      segment.selectors = parse_brackets();
+    } else {
+      fail("expected segment");
+    }
+
+    return segment;
+  }
+
+  std::vector<Selector> parse_brackets() {
+    expect('[');
+    std::vector<Selector> selectors;
+    do {
+      skip_whitespace();
+      selectors.push_back(parse_selector());
+      skip_whitespace();
+    } while (consume(','));
+
+    expect(']');
+    return selectors;
+  }
+
+  Selector parse_selector() {
+    if (peek() == '\'' || peek() == '"') {
+      return Selector{.kind = SelectorKind::NAME, .name = parse_string()};
+    }
+
+    if (consume('*')) {
+      return Selector{.kind = SelectorKind::WILDCARD};
+    }
+
+    if (consume('?')) {
+      skip_whitespace();
+      return Selector{.kind = SelectorKind::FILTER, .filter = parse_or()};
+    }
+
+    Selector selector{.kind = SelectorKind::INDEX};
+    std::optional<int64_t> start = parse_optional_integer();
+    skip_whitespace();
+    if (!consume(':')) {
+      if (!start) {
+        fail("expected selector");
+      }
+
+      selector.index = *start;
+      return selector;
+    }
+
+    selector.kind = SelectorKind::SLICE;
+    selector.start = start;
+    skip_whitespace();
+    selector.end = parse_optional_integer();
+    skip_whitespace();
+    if (consume(':')) {
+      skip_whitespace();
+      selector.step = parse_optional_integer().value_or(1);
+    }
+
+    return selector;
+  }
+
+  // logical-or-expr = logical-and-expr *("||" logical-and-expr)
+  size_t parse_or() {
+    size_t lhs = parse_and();
+    while (skip_whitespace(), consume("||")) {
+      skip_whitespace();
+      lhs = add(Expr{.kind = ExprKind::OR, .lhs = lhs, .rhs = parse_and()});
+    }
+
+    return lhs;
+  }
+
+  // logical-and-expr = basic-expr *("&&" basic-expr)
+  size_t parse_and() {
+    size_t lhs = parse_basic();
+    while (skip_whitespace(), consume("&&")) {
+      skip_whitespace();
+      lhs = add(Expr{.kind = ExprKind::AND, .lhs = lhs, .rhs = parse_basic()});
+    }
+
+    return lhs;
+  }
+
+  size_t parse_basic() {
+    if (consume('!')) {
+      skip_whitespace();
+      return add(Expr{.kind = ExprKind::NOT, .lhs = parse_basic()});
+    }
+
+    if (consume('(')) {
+      skip_whitespace();
+      size_t expr = parse_or();
+      skip_whitespace();
+      expect(')');
+      return expr;
+    }
+
+    Operand left = parse_operand();
+    skip_whitespace();
+    std::optional<CompareOp> op = parse_compare_op();
+    if (!op) {
+      if (!left.query) {
+        fail("expected comparison after literal");
+      }
+
+      return add(Expr{.kind = ExprKind::EXISTS, .left = std::move(left)});
+    }
+
+    skip_whitespace();
+    return add(Expr{.kind = ExprKind::COMPARE,
+                    .op = *op,
+                    .left = std::move(left),
+                    .right = parse_operand()});
+  }
+
+  std::optional<CompareOp> parse_compare_op() {
+    if (consume("==")) {
+      return CompareOp::EQ;
+    } else if (consume("!=")) {
+      return CompareOp::NE;
+    } else if (consume("<=")) {
+      return CompareOp::LE;
+    } else if (consume(">=")) {
+      return CompareOp::GE;
+    } else if (consume('<')) {
+      return CompareOp::LT;
+    } else if (consume('>')) {
+      return CompareOp::GT;
+    }
+
+    return std::nullopt;
+  }
+
+  Operand parse_operand() {
+    if (peek() == '@' || peek() == '$') {
+      SingularQuery query{.absolute = get() == '$'};
+      while (true) {
+        if (consume('.')) {
+          query.steps.emplace_back(parse_shorthand());
+        } else if (consume('[')) {
+          skip_whitespace();
+          if (peek() == '\'' || peek() == '"') {
+            query.steps.emplace_back(parse_string());
+          } else if (std::optional<int64_t> i = parse_optional_integer()) {
+            query.steps.emplace_back(*i);
+          } else {
+            fail("expected name or index in filter query");
+          }
+
+          skip_whitespace();
+          expect(']');
+        } else {
+          return Operand{.query = std::move(query)};
+        }
+      }
+    }
+
+    if (peek() == '\'' || peek() == '"') {
+      return Operand{.literal = parse_string()};
+    }
+
+    if (consume("true")) {
+      return Operand{.literal = true};
+    } else if (consume("false")) {
+      return Operand{.literal = false};
+    } else if (consume("null")) {
+      return Operand{.literal = nullptr};
+    }
+
+    return Operand{.literal = parse_number()};
+  }
+
+  Value parse_number() {
+    size_t start = pos_;
+    bool integral = true;
+    (void)consume('-');
+    while (!eof() && (isdigit(peek()) || peek() == '.' || peek() == 'e' ||
+                      peek() == 'E' || peek() == '+' || peek() == '-')) {
+      integral = integral && isdigit(peek());
+      pos_++;
+    }
+
+    std::string_view number = expression_.substr(start, pos_ - start);
+    if (integral) {
+      int32_t i = 0;
+      auto [end, ec] =
+          std::from_chars(number.data(), number.data() + number.size(), i);
+      if (ec == std::errc() && end == number.data() + number.size()) {
+        return i;
+      }
+    }
+
+    double d = 0;
+    auto [end, ec] =
+        std::from_chars(number.data(), number.data() + number.size(), d);
+    if (ec != std::errc() || end != number.data() + number.size() ||
+        number.empty()) {
+      pos_ = start;
+      fail("expected literal or query");
+    }
+
+    return d;
+  }
+
+  std::optional<int64_t> parse_optional_integer() {
+    size_t start = pos_;
+    (void)consume('-');
+    while (!eof() && isdigit(peek())) {
+      pos_++;
+    }
+
+    if (pos_ == start) {
+      return std::nullopt;
+    }
+
+    int64_t i = 0;
+    auto [end, ec] = std::from_chars(expression_.data() + start,
+                                     expression_.data() + pos_, i);
+    if (ec != std::errc() || end != expression_.data() + pos_) {
+      pos_ = start;
+      fail("invalid integer");
+    }
+
+    return i;
+  }
+
+  // member-name-shorthand: ALPHA / "_" / non-ASCII, then also DIGIT.
+  std::string parse_shorthand() {
+    size_t start = pos_;
+    while (!eof() && (isalpha(peek()) || peek() == '_' ||
+                      (pos_ > start && isdigit(peek())) ||
+                      static_cast<unsigned char>(peek()) >= 0x80)) {
+      pos_++;
+    }
+
+    if (pos_ == start) {
+      fail("expected member name");
+    }
+
+    return std::string(expression_.substr(start, pos_ - start));
+  }
+
+  std::string parse_string() {
+    char quote = get();
+    std::string res;
+    while (!eof() && peek() != quote) {
+      char c = get();
+      if (c != '\\') {
+        res += c;
+        continue;
+      }
+
+      if (eof()) {
+        break;
+      }
+
+      switch (char escaped = get()) {
+        case 'b':
+          res += '\b';
+          break;
+        case 'f':
+          res += '\f';
+          break;
+        case 'n':
+          res += '\n';
+          break;
+        case 'r':
+          res += '\r';
+          break;
+        case 't':
+          res += '\t';
+          break;
+        case '\\':
+        case '/':
+        case '\'':
+        case '"':
+          res += escaped;
+          break;
+        case 'u':
+          res += parse_unicode_escape();
+          break;
+        default:
+          fail("unsupported escape sequence");
+      }
+    }
+
+    expect(quote);
+    return res;
+  }
+
+  // The code point of a \uXXXX escape, whose "\u" has been read; a high
+  // surrogate must be followed by an escaped low surrogate.
+  std::string parse_unicode_escape() {
+    uint32_t code_point = parse_hex4();
+    if (0xDC00 <= code_point && code_point <= 0xDFFF) {
+      fail("unpaired low surrogate");
+    }
+
+    if (0xD800 <= code_point && code_point <= 0xDBFF) {
+      if (!consume("\\u")) {
+        fail("expected low surrogate");
+      }
+
+      uint32_t low = parse_hex4();
+      if (low < 0xDC00 || low > 0xDFFF) {
+        fail("expected low surrogate");
+      }
+
+      code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    return to_utf8(code_point);
+  }
+
+  uint32_t parse_hex4() {
+    uint32_t res = 0;
+    for (size_t i = 0; i < 4; i++) {
+      if (eof() || !isxdigit(peek())) {
+        fail("expected 4 hex digits");
+      }
+
+      char c = char(tolower(get()));
+      res = (res << 4) | uint32_t(c <= '9' ? c - '0' : c - 'a' + 10);
+    }
+
+    return res;
+  }
+
+  size_t add(Expr expr) {
+    path_.exprs_.push_back(std::move(expr));
+    return path_.exprs_.size() - 1;
+  }
+
+  bool eof() const { return pos_ >= expression_.size(); }
+
+  char peek() const { return eof() ? '\0' : expression_[pos_]; }
+
+  char get() { return expression_[pos_++]; }
+
+  bool consume(char c) { return peek() == c && ++pos_; }
+
+  bool consume(std::string_view token) {
+    if (expression_.substr(pos_).starts_with(token)) {
+      pos_ += token.size();
+      return true;
+    }
+
+    return false;
+  }
+
+  void expect(char c) {
+    if (!consume(c)) {
+      fail("expected '" + std::string(1, c) + "'");
+    }
+  }
+
+  void skip_whitespace() {
+    while (!eof() && (peek() == ' ' || peek() == '\t' || peek() == '\n' ||
+                      peek() == '\r')) {
+      pos_++;
+    }
+  }
+
+  static bool isdigit(char c) { return c >= '0' && c <= '9'; }
+
+  static bool isalpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+  }
+
+  [[noreturn]] void fail(const std::string& message) const {
+    throw ParseException("invalid JSONPath at position " +
+                         std::to_string(pos_) + ": " + message + ": " +
+                         std::string(expression_));
+  }
+
+  std::string_view expression_;
+  JsonPath& path_;
+  size_t pos_ = 0;
+};
+
+JsonPath::JsonPath(std::string_view expression) {
+  Compiler(expression, *this).compile();
+}
+
+JsonPath::JsonPath(JsonPath&&) noexcept = default;
+
+JsonPath& JsonPath::operator=(JsonPath&&) noexcept = default;
+
+JsonPath::~JsonPath() = default;
+
+std::vector<const Value*> JsonPath::select(const Value& root) const {
+  std::vector<const Value*> nodes = {&root};
+  std::vector<const Value*> next;
+  std::vector<const Value*> pending;
+  for (const Segment& segment : segments_) {
+    auto apply = [&](const Value& node) {
+      reject_raw(node);
+      for (const Selector& selector : segment.selectors) {
+        switch (selector.kind) {
+          case SelectorKind::NAME:
+            if (const Value* value = node.find(selector.name)) {
+              next.push_back(value);
+            }
+            break;
+          case SelectorKind::WILDCARD:
+            if (node.is_array() || node.is_object()) {
+              for (const Value& value : node) {
+                next.push_back(&value);
+              }
+            }
+            break;
+          case SelectorKind::INDEX:
+            if (const Value* value = child(node, selector.index)) {
+              next.push_back(value);
+            }
+            break;
+          case SelectorKind::SLICE:
+            if (const array_t* array = node.get_if<array_t>()) {
+              // RFC 9535 2.3.4.2.2
+              const int64_t size = int64_t(array->size());
+              const int64_t step = selector.step;
+              auto bound = [size](int64_t i, int64_t lo, int64_t hi) {
+                i = i >= 0 ? i : size + i;
+                return i < lo ? lo : (i > hi ? hi : i);
+              };
+
+              if (step > 0) {
+                int64_t lower = bound(selector.start.value_or(0), 0, size);
+                int64_t upper = bound(selector.end.value_or(size), 0, size);
+                // Stop before `i += step` could overflow on a huge step.
+                for (int64_t i = lower; i < upper; i += step) {
+                  next.push_back(&(*array)[size_t(i)]);
+                  if (step >= upper - i) {
+                    break;
+                  }
+                }
+              } else if (step < 0) {
+                int64_t upper =
+                    bound(selector.start.value_or(size - 1), -1, size - 1);
+                int64_t lower =
+                    bound(selector.end.value_or(-size - 1), -1, size - 1);
+                for (int64_t i = upper; lower < i; i += step) {
+                  next.push_back(&(*array)[size_t(i)]);
+                  if (step <= lower - i) {
+                    break;
+                  }
+                }
+              }
+            }
+            break;
+          case SelectorKind::FILTER:
+            if (node.is_array() || node.is_object()) {
+              for (const Value& value : node) {
+                if (test(selector.filter, root, value)) {
+                  next.push_back(&value);
+                }
+              }
+            }
+            break;
+        }
+      }
+    };
+
+    next.clear();
+    for (const Value* node : nodes) {
+      if (!segment.descendant) {
+        apply(*node);
+        continue;
+      }
+
+      // Pre-order walk of the node and all of its descendants.
+      pending.push_back(node);
+      while (!pending.empty()) {
+        const Value* curr = pending.back();
+        pending.pop_back();
+        apply(*curr);
+        if (const array_t* array = curr->get_if<array_t>()) {
+          for (auto it = array->rbegin(); it != array->rend(); ++it) {
+            pending.push_back(&*it);
+          }
+        } else if (const object_t* object = curr->get_if<object_t>()) {
+          for (auto it = object->rbegin(); it != object->rend(); ++it) {
+            pending.push_back(&it->second);
+          }
+        }
+      }
+    }
+
+    std::swap(nodes, next);
+  }
+
+  return nodes;
+}
+
+std::vector<Value*> JsonPath::select(Value& root) const {
+  std::vector<Value*> nodes;
+  for (const Value* node : select(static_cast<const Value&>(root))) {
+    nodes.push_back(const_cast<Value*>(node));
+  }
+
+  return nodes;
+}
+
+bool JsonPath::test(size_t expr, const Value& root,
+                    const Value& current) const {
+  const Expr& e = exprs_[expr];
+  switch (e.kind) {
+    case ExprKind::OR:
+      return test(e.lhs, root, current) || test(e.rhs, root, current);
+    case ExprKind::AND:
+      return test(e.lhs, root, current) && test(e.rhs, root, current);
+    case ExprKind::NOT:
+      return !test(e.lhs, root, current);
+    case ExprKind::EXISTS:
+      return resolve(*e.left.query, root, current) != nullptr;
+    case ExprKind::COMPARE: {
+      auto operand = [&](const Operand& o) {
+        return o.query ? resolve(*o.query, root, current) : &o.literal;
+      };
+
+      const Value* lhs = operand(e.left);
+      const Value* rhs = operand(e.right);
+      switch (e.op) {
+        case CompareOp::EQ:
+          return equal(lhs, rhs);
+        case CompareOp::NE:
+          return !equal(lhs, rhs);
+        case CompareOp::LT:
+          return less(lhs, rhs);
+        case CompareOp::LE:
+          return less(lhs, rhs) || equal(lhs, rhs);
+        case CompareOp::GT:
+          return less(rhs, lhs);
+        case CompareOp::GE:
+          return less(rhs, lhs) || equal(lhs, rhs);
+      }
+    }
+  }
+
+  __builtin_unreachable();
+}
+
+}  // namespace json
+}  // namespace warren
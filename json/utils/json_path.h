@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+// A JSONPath (RFC 9535) query, compiled once and run against any number of
+// documents:
+//
+//   static const JsonPath kPath("$.orders[?@.total > 100].id");
+//   for (const Value* id : kPath.select(message)) { ... }
+//
+// Supported: name (`.a`, `['a']`), wildcard (`*`), index (`[0]`, `[-1]`),
+// slice (`[start:end:step]`) and filter (`[?...]`) selectors, child and
+// descendant (`..`) segments, and filters built from singular queries
+// (`@.a`, `$.b[0]`), literals, comparisons, `!`, `&&`, `||` and parentheses.
+// Function extensions are not supported.
+//
+// Results point into the queried document, in document order for arrays.
+// Throws ParseException on a malformed expression. A query that has to look
+// inside a Raw value throws BadAccessException; json::expand the document
+// first.
+class JsonPath {
+ public:
+  explicit JsonPath(std::string_view expression);
+
+  JsonPath(JsonPath&&) noexcept;
+  JsonPath& operator=(JsonPath&&) noexcept;
+
+  JsonPath(const JsonPath&) = delete;
+  JsonPath& operator=(const JsonPath&) = delete;
+
+  ~JsonPath();
+
+  std::vector<const Value*> select(const Value& root) const;
+
+  std::vector<Value*> select(Value& root) const;
+
+ private:
+  class Compiler;
+  struct Expr;
+  struct Segment;
+
+  bool test(size_t expr, const Value& root, const Value& current) const;
+
+  std::vector<Segment> segments_;
+  std::vector<Expr> exprs_;
+};
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,183 @@
+#include "warren/json/utils/json_path.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+const Value kStore = R"({
+  "store": {
+    "book": [
+      {"category": "reference", "author": "Rees", "price": 8.95},
+      {"category": "fiction", "author": "Waugh", "price": 12.99},
+      {"category": "fiction", "author": "Melville", "isbn": "0-553",
+       "price": 8.99},
+      {"category": "fiction", "author": "Tolkien", "isbn": "0-395",
+       "price": 22.99}
+    ],
+    "bicycle": {"color": "red", "price": 399}
+  }
+})"_json;
+
+std::vector<Value> select(std::string_view expression,
+                          const Value& root = kStore) {
+  std::vector<Value> res;
+  for (const Value* node : JsonPath(expression).select(root)) {
+    res.push_back(*node);
+  }
+
+  return res;
+}
+
+TEST(JsonPathTest, Root) {
+  EXPECT_THAT(select("$", "[1]"_json), ElementsAre("[1]"_json));
+}
+
+TEST(JsonPathTest, Names) {
+  EXPECT_THAT(select("$.store.bicycle.color"), ElementsAre("red"));
+  EXPECT_THAT(select("$['store']['bicycle'][\"price\"]"), ElementsAre(399));
+  EXPECT_THAT(select("$.store.missing"), IsEmpty());
+  EXPECT_THAT(select("$['a b']", R"({"a b": 1})"_json), ElementsAre(1));
+  EXPECT_THAT(select(R"($['it\'s'])", R"({"it's": 1})"_json), ElementsAre(1));
+}
+
+TEST(JsonPathTest, UnicodeEscapes) {
+  const Value value = R"({"é": 1, "😀": 2, "a\"b": 3})"_json;
+  EXPECT_THAT(select(R"($['\u00e9'])", value), ElementsAre(1));
+  EXPECT_THAT(select(R"($["\u00E9"])", value), ElementsAre(1));
+  EXPECT_THAT(select(R"($['\ud83d\ude00'])", value), ElementsAre(2));
+  EXPECT_THAT(select(R"($['a\u0022b'])", value), ElementsAre(3));
+  EXPECT_THAT(select(R"($[?@ == '\u00e9'])", R"(["é", "e"])"_json),
+              ElementsAre("é"));
+
+  EXPECT_THROW(JsonPath(R"($['\u00e'])"), ParseException);
+  EXPECT_THROW(JsonPath(R"($['\ud83d'])"), ParseException);
+  EXPECT_THROW(JsonPath(R"($['\ude00'])"), ParseException);
+  EXPECT_THROW(JsonPath(R"($['\ud83d\u0041'])"), ParseException);
+}
+
+TEST(JsonPathTest, Wildcard) {
+  EXPECT_THAT(select("$.store.bicycle.*"), ElementsAre("red", 399));
+  EXPECT_THAT(select("$.store.book[*].author"),
+              ElementsAre("Rees", "Waugh", "Melville", "Tolkien"));
+  EXPECT_THAT(select("$.*", "1"_json), IsEmpty());
+}
+
+TEST(JsonPathTest, Indices) {
+  EXPECT_THAT(select("$.store.book[0].author"), ElementsAre("Rees"));
+  EXPECT_THAT(select("$.store.book[-1].author"), ElementsAre("Tolkien"));
+  EXPECT_THAT(select("$.store.book[4]"), IsEmpty());
+  EXPECT_THAT(select("$.store.book[-5]"), IsEmpty());
+  EXPECT_THAT(select("$[0, 2, 0]", "[1, 2, 3]"_json), ElementsAre(1, 3, 1));
+}
+
+TEST(JsonPathTest, Slices) {
+  const Value array = "[0, 1, 2, 3, 4, 5, 6]"_json;
+  EXPECT_THAT(select("$[1:3]", array), ElementsAre(1, 2));
+  EXPECT_THAT(select("$[5:]", array), ElementsAre(5, 6));
+  EXPECT_THAT(select("$[:2]", array), ElementsAre(0, 1));
+  EXPECT_THAT(select("$[1:6:2]", array), ElementsAre(1, 3, 5));
+  EXPECT_THAT(select("$[-2:]", array), ElementsAre(5, 6));
+  EXPECT_THAT(select("$[::-3]", array), ElementsAre(6, 3, 0));
+  EXPECT_THAT(select("$[5:1:-2]", array), ElementsAre(5, 3));
+  EXPECT_THAT(select("$[::0]", array), IsEmpty());
+  EXPECT_THAT(select("$[-100:100:3]", array), ElementsAre(0, 3, 6));
+  EXPECT_THAT(select("$[1:10:9223372036854775807]", array), ElementsAre(1));
+  EXPECT_THAT(select("$[5:0:-9223372036854775808]", array), ElementsAre(5));
+}
+
+TEST(JsonPathTest, Descendants) {
+  EXPECT_THAT(select("$..author"),
+              ElementsAre("Rees", "Waugh", "Melville", "Tolkien"));
+  EXPECT_THAT(select("$.store..price"),
+              ElementsAre(399, 8.95, 12.99, 8.99, 22.99));
+  EXPECT_THAT(select("$..[0]", "[[1, 2], [3]]"_json),
+              ElementsAre("[1, 2]"_json, 1, 3));
+  EXPECT_THAT(select("$..*", R"({"a": [1]})"_json),
+              ElementsAre("[1]"_json, 1));
+}
+
+TEST(JsonPathTest, Filters) {
+  EXPECT_THAT(select("$.store.book[?@.price < 10].author"),
+              ElementsAre("Rees", "Melville"));
+  EXPECT_THAT(select("$.store.book[?@.isbn].author"),
+              ElementsAre("Melville", "Tolkien"));
+  EXPECT_THAT(select("$.store.book[?!@.isbn].author"),
+              ElementsAre("Rees", "Waugh"));
+  EXPECT_THAT(
+      select("$.store.book[?@.category == 'fiction' && @.price >= 12.99]"
+             ".author"),
+      ElementsAre("Waugh", "Tolkien"));
+  EXPECT_THAT(select("$.store.book[?@.author == 'Rees' || (@.isbn && "
+                     "@.price > 20)].author"),
+              ElementsAre("Rees", "Tolkien"));
+  EXPECT_THAT(select("$.store.book[?@.price <= $.store.book[0].price].author"),
+              ElementsAre("Rees"));
+  EXPECT_THAT(select("$[?@ != 2]", "[1, 2, 3]"_json), ElementsAre(1, 3));
+  EXPECT_THAT(select("$[?@ == 2.0]", "[1, 2, 3]"_json), ElementsAre(2));
+  EXPECT_THAT(select("$[?@ > 'b']", R"(["a", "b", "c", 3])"_json),
+              ElementsAre("c"));
+  EXPECT_THAT(select("$[?@.a == null]", R"([{"a": null}, {}])"_json),
+              ElementsAre(R"({"a": null})"_json));
+  EXPECT_THAT(select("$[?@.a == @.b]", R"([{"a": 1}, {}])"_json),
+              ElementsAre("{}"_json));
+  EXPECT_THAT(select("$[?@[0] == true]", "[[true], [false], []]"_json),
+              ElementsAre("[true]"_json));
+}
+
+TEST(JsonPathTest, Raw) {
+  Value value = object_t{{"a", Raw{R"({"b": 1})"}}, {"c", array_t{1}}};
+  EXPECT_THAT(select("$.a", value), ElementsAre(Value(Raw{R"({"b": 1})"})));
+  EXPECT_THAT(select("$.c[0]", value), ElementsAre(1));
+  EXPECT_THROW(select("$.a.b", value), BadAccessException);
+  EXPECT_THROW(select("$..b", value), BadAccessException);
+  EXPECT_THROW(select("$[?@ == 1]", value), BadAccessException);
+
+  expand(value);
+  EXPECT_THAT(select("$.a.b", value), ElementsAre(1));
+  EXPECT_THAT(select("$..b", value), ElementsAre(1));
+}
+
+TEST(JsonPathTest, SelectMutable) {
+  Value value = R"({"a": [1, 2, 3]})"_json;
+  for (Value* node : JsonPath("$.a[?@ > 1]").select(value)) {
+    *node = 0;
+  }
+
+  EXPECT_THAT(value, Eq(R"({"a": [1, 0, 0]})"_json));
+}
+
+TEST(JsonPathTest, Reusable) {
+  const JsonPath path("$.a");
+  EXPECT_THAT(path.select(R"({"a": 1})"_json).size(), Eq(1u));
+  EXPECT_THAT(path.select(R"({"b": 1})"_json).size(), Eq(0u));
+}
+
+TEST(JsonPathTest, Malformed) {
+  EXPECT_THROW(JsonPath(""), ParseException);
+  EXPECT_THROW(JsonPath("a"), ParseException);
+  EXPECT_THROW(JsonPath("$."), ParseException);
+  EXPECT_THROW(JsonPath("$[0"), ParseException);
+  EXPECT_THROW(JsonPath("$['a]"), ParseException);
+  EXPECT_THROW(JsonPath("$[?@.a ==]"), ParseException);
+  EXPECT_THROW(JsonPath("$[?1]"), ParseException);
+  EXPECT_THROW(JsonPath("$[?(@.a]"), ParseException);
+  EXPECT_THROW(JsonPath("$[]"), ParseException);
+  EXPECT_THROW(JsonPath("$.a b"), ParseException);
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <utility>  // move
+#include <vector>
 
 #include "warren/json/parse/lexer.h"
 #include "warren/json/parse/parser.h"
@@ -13,8 +15,49 @@ inline Value operator""_json(const char* json, size_t len) {
   return Parser(Lexer(std::string(json, len))).parse();
 }
 
-inline Value parse(std::string json) {
-  return Parser(Lexer(std::move(json))).parse();
+inline Value parse(std::string json, const LexOptions& opts = {}) {
+  return Parser(std::move(json), opts).parse();
+}
+
+// Wraps serialized JSON in a Raw value once it has been checked to parse.
+// Use Value(Raw{json}) directly to trust the input without checking it.
+inline Value raw(std::string json) {
+  parse(json);
+  return Raw{std::move(json)};
+}
+
+// Whether `value` holds a Raw value anywhere in its tree.
+inline bool contains_raw(const Value& value) {
+  std::vector<const Value*> pending = {&value};
+  while (!pending.empty()) {
+    const Value* curr = pending.back();
+    pending.pop_back();
+    if (curr->is_raw()) {
+      return true;
+    } else if (curr->is_array() || curr->is_object()) {
+      for (const Value& child : *curr) {
+        pending.push_back(&child);
+      }
+    }
+  }
+
+  return false;
+}
+
+// Replaces every Raw value in `value` with its parsed tree.
+inline void expand(Value& value) {
+  std::vector<Value*> pending = {&value};
+  while (!pending.empty()) {
+    Value* curr = pending.back();
+    pending.pop_back();
+    if (curr->is_raw()) {
+      *curr = parse(curr->raw());
+    } else if (curr->is_array() || curr->is_object()) {
+      for (Value& child : *curr) {
+        pending.push_back(&child);
+      }
+    }
+  }
 }
 
 }  // namespace json
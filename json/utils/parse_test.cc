@@ -2,6 +2,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "warren/json/utils/exception.h"
 
 namespace warren {
 namespace json {
@@ -19,6 +20,32 @@ TEST(UtilsTest, Parse) {
               Eq(parse("{\"key\": \"value\", \"other\": 10}")));
 }
 
+TEST(UtilsTest, ParseWithLexOptions) {
+  EXPECT_THAT(parse("[\"\xff\"]"), Eq(array_t{"\xff"}));
+  EXPECT_THROW(parse("[\"\xff\"]", {.validate_utf8 = true}), ParseException);
+  EXPECT_THAT(parse("[\"caf\xc3\xa9\"]", {.validate_utf8 = true}),
+              Eq(array_t{"caf\xc3\xa9"}));
+}
+
+TEST(UtilsTest, Raw) {
+  Value value = raw(R"({"b": [1, 2]})");
+  EXPECT_THAT(value.is_raw(), Eq(true));
+  EXPECT_THAT(value.is_object(), Eq(false));
+  EXPECT_THAT(value.raw(), Eq(R"({"b": [1, 2]})"));
+  EXPECT_THROW(raw("{"), ParseException);
+  EXPECT_THROW(raw("1 2"), ParseException);
+}
+
+TEST(UtilsTest, Expand) {
+  Value value = object_t{{"a", Raw{R"({"b": [1, 2]})"}},
+                         {"c", array_t{Raw{"true"}, 3}}};
+  Value copy = value;
+  EXPECT_THAT(copy, Eq(value));
+  expand(value);
+  EXPECT_THAT(value, Eq(R"({"a": {"b": [1, 2]}, "c": [true, 3]})"_json));
+  EXPECT_THAT(copy["a"].is_raw(), Eq(true));
+}
+
 }  // namespace
 }  // namespace json
 }  // namespace warren
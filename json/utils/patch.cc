@@ -0,0 +1,405 @@
+#include "warren/json/utils/patch.h"
+
+#include <algorithm>  // equal
+#include <cstddef>    // ptrdiff_t, size_t
+#include <deque>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/value.h"
+
+namespace {
+
+using warren::json::array_t;
+using warren::json::object_t;
+using warren::json::PatchException;
+using warren::json::Value;
+
+// Splits an RFC 6901 pointer into its unescaped reference tokens.
+std::optional<std::vector<std::string>> split(std::string_view pointer) {
+  std::vector<std::string> tokens;
+  if (pointer.empty()) {
+    return tokens;
+  }
+
+  if (pointer[0] != '/') {
+    return std::nullopt;
+  }
+
+  std::string token;
+  for (size_t i = 1; i <= pointer.size(); i++) {
+    if (i == pointer.size() || pointer[i] == '/') {
+      tokens.push_back(std::move(token));
+      token.clear();
+    } else if (pointer[i] != '~') {
+      token += pointer[i];
+    } else if (i + 1 < pointer.size() && pointer[i + 1] == '0') {
+      token += '~';
+      i++;
+    } else if (i + 1 < pointer.size() && pointer[i + 1] == '1') {
+      token += '/';
+      i++;
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  return tokens;
+}
+
+// "0" or a run of digits without a leading zero.
+std::optional<size_t> to_index(std::string_view token) {
+  if (token.empty() || token.size() > 18 ||
+      (token.size() > 1 && token[0] == '0')) {
+    return std::nullopt;
+  }
+
+  size_t index = 0;
+  for (char c : token) {
+    if (c < '0' || c > '9') {
+      return std::nullopt;
+    }
+
+    index = index * 10 + size_t(c - '0');
+  }
+
+  return index;
+}
+
+Value* child(Value& parent, const std::string& token) {
+  if (parent.is_object()) {
+    return parent.find(token);
+  }
+
+  if (array_t* array = parent.get_if<array_t>()) {
+    std::optional<size_t> index = to_index(token);
+    return index && *index < array->size() ? &(*array)[*index] : nullptr;
+  }
+
+  return nullptr;
+}
+
+Value* walk(Value& root, const std::vector<std::string>& tokens,
+            size_t depth) {
+  Value* curr = &root;
+  for (size_t i = 0; curr && i < depth; i++) {
+    curr = child(*curr, tokens[i]);
+  }
+
+  return curr;
+}
+
+// Like walk, but replaces Raw values on the way with their parsed trees so
+// that the path can reach into them.
+Value* walk_expanding(Value& root, const std::vector<std::string>& tokens,
+                      size_t depth) {
+  Value* curr = &root;
+  for (size_t i = 0; curr; i++) {
+    if (curr->is_raw()) {
+      *curr = warren::json::parse(curr->raw());
+    }
+
+    if (i == depth) {
+      break;
+    }
+
+    curr = child(*curr, tokens[i]);
+  }
+
+  return curr;
+}
+
+// Copies out of a const patch, moves out of a mutable one.
+template <typename T>
+Value take(T& value) {
+  if constexpr (std::is_const_v<T>) {
+    return value;
+  } else {
+    return std::move(value);
+  }
+}
+
+struct Path {
+  std::string_view pointer;
+  std::vector<std::string> tokens;
+};
+
+class Patcher {
+ public:
+  explicit Patcher(Value& doc) : doc_(doc) {}
+
+  template <typename T>
+  void apply(T& op) {
+    if (op.is_raw()) {
+      Value parsed = warren::json::parse(op.raw());
+      apply(parsed);
+      return;
+    }
+
+    if (!op.is_object()) {
+      throw PatchException("patch operation is not an object");
+    }
+
+    std::string_view name =
+        member(op, "op").template value_or<std::string_view>({});
+    Path path = parse_path(op, "path");
+    if (name == "add") {
+      add(path, take(member(op, "value")));
+    } else if (name == "remove") {
+      (void)remove(path);
+    } else if (name == "replace") {
+      Value& target = find(path);
+      target = take(member(op, "value"));
+    } else if (name == "move") {
+      move(parse_path(op, "from"), path);
+    } else if (name == "copy") {
+      Value copy = find(parse_path(op, "from"));
+      add(path, std::move(copy));
+    } else if (name == "test") {
+      // Raw values compare by their parsed trees.
+      Value& target = find(path);
+      warren::json::expand(target);
+      Value expected = member(op, "value");
+      warren::json::expand(expected);
+      if (!(target == expected)) {
+        throw PatchException("test failed: " + std::string(path.pointer));
+      }
+    } else {
+      throw PatchException("unknown patch operation: " + std::string(name));
+    }
+  }
+
+ private:
+  template <typename T>
+  static T& member(T& op, const char* name) {
+    if (auto* value = op.find(name)) {
+      return *value;
+    }
+
+    throw PatchException("patch operation missing '" + std::string(name) +
+                         "'");
+  }
+
+  template <typename T>
+  static Path parse_path(T& op, const char* name) {
+    std::optional<std::string_view> pointer =
+        member(op, name).template try_get<std::string_view>();
+    if (!pointer) {
+      throw PatchException("'" + std::string(name) + "' is not a string");
+    }
+
+    std::optional<std::vector<std::string>> tokens = split(*pointer);
+    if (!tokens) {
+      throw PatchException("invalid JSON pointer: " + std::string(*pointer));
+    }
+
+    return Path{.pointer = *pointer, .tokens = std::move(*tokens)};
+  }
+
+  Value& find(const Path& path) {
+    if (Value* value = walk_expanding(doc_, path.tokens, path.tokens.size())) {
+      return *value;
+    }
+
+    throw PatchException("path not found: " + std::string(path.pointer));
+  }
+
+  Value& parent(const Path& path) {
+    if (Value* value =
+            walk_expanding(doc_, path.tokens, path.tokens.size() - 1)) {
+      return *value;
+    }
+
+    throw PatchException("path not found: " + std::string(path.pointer));
+  }
+
+  void add(const Path& path, Value value) {
+    if (path.tokens.empty()) {
+      doc_ = std::move(value);
+      return;
+    }
+
+    Value& container = parent(path);
+    const std::string& token = path.tokens.back();
+    if (object_t* object = container.get_if<object_t>()) {
+      object->insert_or_assign(token, std::move(value));
+      return;
+    }
+
+    array_t* array = container.get_if<array_t>();
+    if (!array) {
+      throw PatchException("path not found: " + std::string(path.pointer));
+    }
+
+    if (token == "-") {
+      array->push_back(std::move(value));
+      return;
+    }
+
+    std::optional<size_t> index = to_index(token);
+    if (!index || *index > array->size()) {
+      throw PatchException("invalid array index: " + std::string(path.pointer));
+    }
+
+    array->insert(array->begin() + ptrdiff_t(*index), std::move(value));
+  }
+
+  Value remove(const Path& path) {
+    if (path.tokens.empty()) {
+      return std::exchange(doc_, nullptr);
+    }
+
+    Value& container = parent(path);
+    const std::string& token = path.tokens.back();
+    if (object_t* object = container.get_if<object_t>()) {
+      auto it = object->find(token);
+      if (it != object->end()) {
+        Value removed = std::move(it->second);
+        object->erase(it);
+        return removed;
+      }
+    } else if (array_t* array = container.get_if<array_t>()) {
+      std::optional<size_t> index = to_index(token);
+      if (index && *index < array->size()) {
+        auto it = array->begin() + ptrdiff_t(*index);
+        Value removed = std::move(*it);
+        array->erase(it);
+        return removed;
+      }
+    }
+
+    throw PatchException("path not found: " + std::string(path.pointer));
+  }
+
+  void move(const Path& from, const Path& path) {
+    if (from.tokens == path.tokens) {
+      (void)find(from);
+      return;
+    }
+
+    if (from.tokens.size() < path.tokens.size() &&
+        std::equal(from.tokens.begin(), from.tokens.end(),
+                   path.tokens.begin())) {
+      throw PatchException("cannot move " + std::string(from.pointer) +
+                           " into its own child " + std::string(path.pointer));
+    }
+
+    add(path, remove(from));
+  }
+
+  Value& doc_;
+};
+
+template <typename T>
+void apply(Value& doc, T& patch) {
+  if (patch.is_raw()) {
+    Value parsed = warren::json::parse(patch.raw());
+    apply(doc, parsed);
+    return;
+  }
+
+  auto* ops = patch.template get_if<array_t>();
+  if (!ops) {
+    throw PatchException("patch is not an array");
+  }
+
+  Patcher patcher(doc);
+  for (auto& op : *ops) {
+    patcher.apply(op);
+  }
+}
+
+// RFC 7386 MergePatch, run from a worklist of (target, patch) pairs so deeply
+// nested patches do not recurse. Raw values on either side are parsed first.
+template <typename T>
+void merge(Value& target, T& patch) {
+  // Parsed Raw patches; a deque keeps the pointers in `pending` valid.
+  std::deque<Value> expanded;
+  std::vector<std::pair<Value*, T*>> pending = {{&target, &patch}};
+  while (!pending.empty()) {
+    auto [curr, diff] = pending.back();
+    pending.pop_back();
+
+    if (diff->is_raw()) {
+      diff = &expanded.emplace_back(warren::json::parse(diff->raw()));
+    }
+
+    auto* members = diff->template get_if<object_t>();
+    if (!members) {
+      *curr = take(*diff);
+      continue;
+    }
+
+    if (curr->is_raw()) {
+      *curr = warren::json::parse(curr->raw());
+    }
+
+    if (!curr->is_object()) {
+      *curr = object_t{};
+    }
+
+    // Members of a std::map stay put as siblings are added, so the pointers
+    // in `pending` stay valid.
+    // A Raw member is parsed before the null test, so Raw{"null"} deletes
+    // its key too.
+    for (auto& [key, value] : *members) {
+      T* member = &value;
+      if (member->is_raw()) {
+        member = &expanded.emplace_back(warren::json::parse(member->raw()));
+      }
+
+      if (member->is_null()) {
+        curr->erase(key);
+      } else {
+        pending.emplace_back(&(*curr)[key], member);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+Value* resolve(Value& root, std::string_view pointer) {
+  std::optional<std::vector<std::string>> tokens = split(pointer);
+  return tokens ? walk(root, *tokens, tokens->size()) : nullptr;
+}
+
+const Value* resolve(const Value& root, std::string_view pointer) {
+  return resolve(const_cast<Value&>(root), pointer);
+}
+
+Value* resolve(Value& root, std::string_view pointer,
+               std::vector<Value*>& ancestors) {
+  std::optional<std::vector<std::string>> tokens = split(pointer);
+  if (!tokens) {
+    return nullptr;
+  }
+
+  Value* curr = &root;
+  for (size_t i = 0; curr && i < tokens->size(); i++) {
+    ancestors.push_back(curr);
+    curr = child(*curr, (*tokens)[i]);
+  }
+
+  return curr;
+}
+
+void apply_patch(Value& doc, const Value& patch) { apply(doc, patch); }
+
+void apply_patch(Value& doc, Value&& patch) { apply(doc, patch); }
+
+void merge_patch(Value& target, const Value& patch) { merge(target, patch); }
+
+void merge_patch(Value& target, Value&& patch) { merge(target, patch); }
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+// RFC 6901 JSON Pointer lookup. Returns nullptr if the pointer is malformed
+// or does not resolve.
+Value* resolve(Value& root, std::string_view pointer);
+
+const Value* resolve(const Value& root, std::string_view pointer);
+
+// Like resolve, but also collects the values the pointer passes through on
+// the way, from `root` down to the target's parent.
+Value* resolve(Value& root, std::string_view pointer,
+               std::vector<Value*>& ancestors);
+
+// RFC 6902 JSON Patch, applied to `doc` in place. Each operation resolves its
+// path once down to the parent container; `move` relocates the subtree
+// without copying it, and the rvalue overload moves operation values out of
+// `patch` instead of copying them.
+//
+// Throws PatchException on a malformed operation, an unresolvable path or a
+// failed `test`. Operations are applied in order and are not rolled back on
+// failure; patch a copy if the document must be left untouched. Raw values
+// that a path passes through or a `test` compares are parsed in place in
+// `doc`.
+void apply_patch(Value& doc, const Value& patch);
+
+void apply_patch(Value& doc, Value&& patch);
+
+// RFC 7386 JSON Merge Patch, applied to `target` in place. Raw values in the
+// patch are parsed, as are Raw values in `target` that an object merges into.
+void merge_patch(Value& target, const Value& patch);
+
+void merge_patch(Value& target, Value&& patch);
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,268 @@
+#include "warren/json/utils/patch.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+using ::testing::IsNull;
+using ::testing::Pointee;
+using ::testing::Throws;
+
+TEST(PatchTest, Resolve) {
+  Value doc = R"({"a/b": [0, {"m~n": 1}], "": 2})"_json;
+
+  EXPECT_THAT(resolve(doc, ""), Pointee(Eq(doc)));
+  EXPECT_THAT(resolve(doc, "/"), Pointee(Eq(2)));
+  EXPECT_THAT(resolve(doc, "/a~1b/0"), Pointee(Eq(0)));
+  EXPECT_THAT(resolve(doc, "/a~1b/1/m~0n"), Pointee(Eq(1)));
+  EXPECT_THAT(resolve(doc, "/a~1b/2"), IsNull());
+  EXPECT_THAT(resolve(doc, "/a~1b/01"), IsNull());
+  EXPECT_THAT(resolve(doc, "/missing"), IsNull());
+  EXPECT_THAT(resolve(doc, "a"), IsNull());
+  EXPECT_THAT(resolve(doc, "/a~2b"), IsNull());
+
+  std::vector<Value*> ancestors;
+  EXPECT_THAT(resolve(doc, "/a~1b/1/m~0n", ancestors), Pointee(Eq(1)));
+  EXPECT_THAT(ancestors, ElementsAre(&doc, &doc["a/b"], &doc["a/b"][1]));
+  ancestors.clear();
+  EXPECT_THAT(resolve(doc, "", ancestors), Eq(&doc));
+  EXPECT_THAT(ancestors, IsEmpty());
+}
+
+TEST(PatchTest, Add) {
+  Value doc = R"({"foo": ["bar", "baz"]})"_json;
+  apply_patch(doc, R"([
+    {"op": "add", "path": "/foo/1", "value": "qux"},
+    {"op": "add", "path": "/foo/-", "value": "end"},
+    {"op": "add", "path": "/child", "value": {"grand": 1}},
+    {"op": "add", "path": "/child/grand", "value": 2}
+  ])"_json);
+
+  EXPECT_THAT(doc, Eq(R"({
+    "foo": ["bar", "qux", "baz", "end"],
+    "child": {"grand": 2}
+  })"_json));
+}
+
+TEST(PatchTest, Remove) {
+  Value doc = R"({"foo": ["bar", "qux", "baz"], "baz": 1})"_json;
+  apply_patch(doc, R"([
+    {"op": "remove", "path": "/foo/1"},
+    {"op": "remove", "path": "/baz"}
+  ])"_json);
+
+  EXPECT_THAT(doc, Eq(R"({"foo": ["bar", "baz"]})"_json));
+}
+
+TEST(PatchTest, Replace) {
+  Value doc = R"({"foo": {"bar": 1}, "baz": [1]})"_json;
+  apply_patch(doc, R"([
+    {"op": "replace", "path": "/foo/bar", "value": [2]},
+    {"op": "replace", "path": "/baz/0", "value": "x"}
+  ])"_json);
+
+  EXPECT_THAT(doc, Eq(R"({"foo": {"bar": [2]}, "baz": ["x"]})"_json));
+}
+
+TEST(PatchTest, ReplaceRoot) {
+  Value doc = "[1]"_json;
+  apply_patch(doc,
+              R"([{"op": "replace", "path": "", "value": {"a": 1}}])"_json);
+
+  EXPECT_THAT(doc, Eq(R"({"a": 1})"_json));
+}
+
+TEST(PatchTest, Move) {
+  Value doc = R"({"foo": {"bar": "baz", "waldo": "fred"}, "qux": {}})"_json;
+  apply_patch(doc, R"([
+    {"op": "move", "from": "/foo/waldo", "path": "/qux/thud"},
+    {"op": "move", "from": "/foo", "path": "/qux/foo"}
+  ])"_json);
+
+  EXPECT_THAT(doc,
+              Eq(R"({"qux": {"thud": "fred", "foo": {"bar": "baz"}}})"_json));
+}
+
+TEST(PatchTest, MoveArrayElement) {
+  Value doc = R"(["all", "grass", "cows", "eat"])"_json;
+  apply_patch(doc, R"([{"op": "move", "from": "/1", "path": "/3"}])"_json);
+
+  EXPECT_THAT(doc, Eq(R"(["all", "cows", "eat", "grass"])"_json));
+}
+
+TEST(PatchTest, MoveIntoOwnChildThrows) {
+  Value doc = R"({"a": {"b": {}}})"_json;
+  EXPECT_THAT(
+      [&doc]() {
+        apply_patch(doc,
+                    R"([{"op": "move", "from": "/a", "path": "/a/b/c"}])"_json);
+      },
+      Throws<PatchException>());
+}
+
+TEST(PatchTest, Copy) {
+  Value doc = R"({"a": {"b": [1]}})"_json;
+  apply_patch(doc, R"([{"op": "copy", "from": "/a", "path": "/c"}])"_json);
+  (*resolve(doc, "/c/b"))[0] = 2;
+
+  EXPECT_THAT(doc, Eq(R"({"a": {"b": [1]}, "c": {"b": [2]}})"_json));
+}
+
+TEST(PatchTest, Test) {
+  Value doc = R"({"baz": "qux", "foo": ["a", 2, "c"]})"_json;
+  apply_patch(doc, R"([
+    {"op": "test", "path": "/baz", "value": "qux"},
+    {"op": "test", "path": "/foo/1", "value": 2.0}
+  ])"_json);
+
+  EXPECT_THAT(
+      [&doc]() {
+        apply_patch(doc,
+                    R"([{"op": "test", "path": "/baz", "value": "bar"}])"_json);
+      },
+      Throws<PatchException>());
+}
+
+TEST(PatchTest, Errors) {
+  Value doc = R"({"a": [1]})"_json;
+  for (const char* patch : {
+           R"({"op": "add", "path": "/b", "value": 1})",
+           R"([{"op": "add", "path": "/b"}])",
+           R"([{"op": "add", "path": "/x/y", "value": 1}])",
+           R"([{"op": "add", "path": "/a/2", "value": 1}])",
+           R"([{"op": "add", "path": "/a/01", "value": 1}])",
+           R"([{"op": "remove", "path": "/b"}])",
+           R"([{"op": "remove", "path": "/a/1"}])",
+           R"([{"op": "replace", "path": "/b", "value": 1}])",
+           R"([{"op": "copy", "from": "/b", "path": "/c"}])",
+           R"([{"op": "frobnicate", "path": "/a"}])",
+           R"([{"path": "/a"}])",
+           R"([{"op": "remove", "path": 1}])",
+           R"([{"op": "remove", "path": "a"}])",
+       }) {
+    EXPECT_THAT([&]() { apply_patch(doc, parse(patch)); },
+                Throws<PatchException>())
+        << patch;
+  }
+
+  EXPECT_THAT(doc, Eq(R"({"a": [1]})"_json));
+}
+
+TEST(PatchTest, MovesValuesOutOfRvaluePatch) {
+  Value doc = object_t{};
+  Value patch = R"([{"op": "add", "path": "/a", "value": [1, 2]}])"_json;
+  apply_patch(doc, std::move(patch));
+
+  EXPECT_THAT(doc, Eq(R"({"a": [1, 2]})"_json));
+}
+
+TEST(PatchTest, ConstPatchIsUnchanged) {
+  Value doc = object_t{};
+  const Value patch = R"([{"op": "add", "path": "/a", "value": [1, 2]}])"_json;
+  apply_patch(doc, patch);
+
+  EXPECT_THAT(doc, Eq(R"({"a": [1, 2]})"_json));
+  EXPECT_THAT(patch,
+              Eq(R"([{"op": "add", "path": "/a", "value": [1, 2]}])"_json));
+}
+
+TEST(PatchTest, MergePatch) {
+  Value target = R"({
+    "title": "Goodbye!",
+    "author": {"givenName": "John", "familyName": "Doe"},
+    "tags": ["example", "sample"],
+    "content": "This will be unchanged"
+  })"_json;
+  merge_patch(target, R"({
+    "title": "Hello!",
+    "phoneNumber": "+01-123-456-7890",
+    "author": {"familyName": null},
+    "tags": ["example"]
+  })"_json);
+
+  EXPECT_THAT(target, Eq(R"({
+    "title": "Hello!",
+    "author": {"givenName": "John"},
+    "tags": ["example"],
+    "content": "This will be unchanged",
+    "phoneNumber": "+01-123-456-7890"
+  })"_json));
+}
+
+TEST(PatchTest, MergePatchReplacesNonObjects) {
+  Value target = R"({"a": [1], "b": "c"})"_json;
+  const Value patch = R"({"a": {"x": 1}, "b": {"c": null}})"_json;
+  merge_patch(target, patch);
+  EXPECT_THAT(target, Eq(R"({"a": {"x": 1}, "b": {}})"_json));
+
+  merge_patch(target, "[1]"_json);
+  EXPECT_THAT(target, Eq("[1]"_json));
+
+  merge_patch(target, R"({"a": null})"_json);
+  EXPECT_THAT(target, Eq(object_t{}));
+}
+
+TEST(PatchTest, MergePatchDeeplyNested) {
+  Value patch;
+  Value* curr = &patch;
+  for (size_t i = 0; i < 1'000'000; i++) {
+    curr = &(*curr)["a"];
+  }
+
+  *curr = 1;
+  Value target;
+  merge_patch(target, patch);
+  EXPECT_THAT(target, Eq(patch));
+
+  Value moved;
+  merge_patch(moved, std::move(patch));
+  EXPECT_THAT(moved, Eq(target));
+}
+
+TEST(PatchTest, Raw) {
+  Value doc = object_t{{"a", Raw{R"({"b": [1, 2]})"}}};
+  apply_patch(doc, Value(Raw{R"([
+    {"op": "test", "path": "/a", "value": {"b": [1, 2]}},
+    {"op": "add", "path": "/a/b/-", "value": 3}
+  ])"}));
+  apply_patch(doc, array_t{Raw{R"({"op": "remove", "path": "/a/b/0"})"}});
+  EXPECT_THAT(doc, Eq(R"({"a": {"b": [2, 3]}})"_json));
+
+  doc = object_t{{"a", Raw{R"({"b": 1, "c": 2})"}}};
+  apply_patch(doc, R"([{"op": "test", "path": "", "value": {"a": {"b": 1,
+                        "c": 2}}}])"_json);
+
+  Value target = object_t{{"a", Raw{R"({"b": 1, "c": 2})"}}, {"d", 4}};
+  merge_patch(target, object_t{{"a", Raw{R"({"b": null, "e": 5})"}}});
+  EXPECT_THAT(target, Eq(R"({"a": {"c": 2, "e": 5}, "d": 4})"_json));
+
+  merge_patch(target, Value(Raw{R"({"d": null})"}));
+  EXPECT_THAT(target, Eq(R"({"a": {"c": 2, "e": 5}})"_json));
+
+  merge_patch(target, object_t{{"a", Raw{"[1]"}}});
+  EXPECT_THAT(target, Eq(R"({"a": [1]})"_json));
+
+  target = R"({"a": 1, "b": 2})"_json;
+  merge_patch(target, object_t{{"a", Raw{"null"}}});
+  EXPECT_THAT(target, Eq(R"({"b": 2})"_json));
+
+  const Value patch = object_t{{"b", Raw{" null "}}};
+  merge_patch(target, patch);
+  EXPECT_THAT(target, Eq(object_t{}));
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
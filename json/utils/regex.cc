@@ -0,0 +1,681 @@
+#include "warren/json/utils/regex.h"
+
+#include <algorithm>  // all_of, sort, upper_bound
+#include <cstddef>    // size_t
+#include <cstdint>    // uint8_t, uint32_t
+#include <iterator>   // prev
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>  // move, pair, swap
+#include <vector>
+
+namespace {
+
+using Ranges = std::vector<std::pair<char32_t, char32_t>>;
+
+constexpr char32_t kMaxCodePoint = 0x10ffff;
+
+// Stands for the missing character before the start or after the end of the
+// input.
+constexpr char32_t kNone = 0xffffffff;
+
+// The parser recurses once per group, so nesting is bounded. Counted
+// repetition copies its operand, so the program size is bounded too, and
+// counts are clamped to it.
+constexpr size_t kMaxDepth = 256;
+constexpr uint32_t kMaxProgram = 1 << 16;
+
+constexpr uint32_t kUnbounded = 0xffffffff;
+
+[[noreturn]] void invalid(const std::string& message) {
+  throw std::invalid_argument("invalid regular expression: " + message);
+}
+
+// Decodes the UTF-8 sequence at s[i], advancing `i` past it. Invalid
+// sequences decode to U+FFFD and consume one byte.
+char32_t decode(std::string_view s, size_t& i) {
+  uint8_t c = static_cast<uint8_t>(s[i]);
+  if (c < 0x80) {
+    i++;
+    return c;
+  }
+
+  size_t len = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 0;
+  char32_t cp = c & (0x7f >> len);
+  if (len == 0 || c >= 0xf8 || i + len > s.size()) {
+    i++;
+    return 0xfffd;
+  }
+
+  for (size_t k = 1; k < len; k++) {
+    uint8_t cont = static_cast<uint8_t>(s[i + k]);
+    if ((cont & 0xc0) != 0x80) {
+      i++;
+      return 0xfffd;
+    }
+
+    cp = (cp << 6) | (cont & 0x3f);
+  }
+
+  constexpr char32_t kMin[] = {0, 0, 0x80, 0x800, 0x10000};
+  if (cp < kMin[len] || cp > kMaxCodePoint || (cp >= 0xd800 && cp <= 0xdfff)) {
+    i++;
+    return 0xfffd;
+  }
+
+  i += len;
+  return cp;
+}
+
+bool is_word(char32_t c) {
+  return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') ||
+         (c >= 'a' && c <= 'z') || c == '_';
+}
+
+// Sorts `ranges` and merges the ones that overlap or touch.
+Ranges normalize(Ranges ranges) {
+  std::sort(ranges.begin(), ranges.end());
+  Ranges res;
+  for (const auto& [lo, hi] : ranges) {
+    if (!res.empty() && lo <= res.back().second + 1) {
+      res.back().second = std::max(res.back().second, hi);
+    } else {
+      res.emplace_back(lo, hi);
+    }
+  }
+
+  return res;
+}
+
+Ranges complement(const Ranges& ranges) {
+  Ranges res;
+  char32_t next = 0;
+  for (const auto& [lo, hi] : normalize(ranges)) {
+    if (lo > next) {
+      res.emplace_back(next, lo - 1);
+    }
+
+    next = hi + 1;
+  }
+
+  if (next <= kMaxCodePoint) {
+    res.emplace_back(next, kMaxCodePoint);
+  }
+
+  return res;
+}
+
+Ranges digit() { return {{'0', '9'}}; }
+
+Ranges word() { return {{'0', '9'}, {'A', 'Z'}, {'_', '_'}, {'a', 'z'}}; }
+
+// ECMAScript WhiteSpace and LineTerminator.
+Ranges space() {
+  return {{0x09, 0x0d}, {0x20, 0x20},     {0xa0, 0xa0},
+          {0x1680, 0x1680}, {0x2000, 0x200a}, {0x2028, 0x2029},
+          {0x202f, 0x202f}, {0x205f, 0x205f}, {0x3000, 0x3000},
+          {0xfeff, 0xfeff}};
+}
+
+// Everything but a LineTerminator.
+Ranges dot() {
+  return complement({{'\n', '\n'}, {'\r', '\r'}, {0x2028, 0x2029}});
+}
+
+bool is_single(const Ranges& ranges) {
+  return ranges.size() == 1 && ranges[0].first == ranges[0].second;
+}
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+class Regex::Compiler {
+ public:
+  Compiler(std::string_view pattern, Regex& regex)
+      : pattern_(pattern), regex_(regex) {}
+
+  void run() {
+    Node root = alternation(0);
+    if (pos_ < pattern_.size()) {
+      invalid("unmatched ')'");
+    }
+
+    emit(root);
+    push({.op = Inst::MATCH});
+  }
+
+ private:
+  struct Node {
+    enum Kind { CLASS, ASSERTION, SEQUENCE, ALTERNATION, REPEAT };
+
+    Kind kind;
+    // The instruction of an ASSERTION.
+    Inst::Op op = Inst::MATCH;
+    // The index in classes_ of a CLASS.
+    uint32_t index = 0;
+    // The bounds of a REPEAT.
+    uint32_t min = 0;
+    uint32_t max = 0;
+    std::vector<Node> children = {};
+  };
+
+  bool eof() const { return pos_ == pattern_.size(); }
+
+  char peek() const { return eof() ? '\0' : pattern_[pos_]; }
+
+  bool accept(char c) {
+    if (peek() != c || eof()) {
+      return false;
+    }
+
+    pos_++;
+    return true;
+  }
+
+  char32_t next() {
+    if (eof()) {
+      invalid("unexpected end of pattern");
+    }
+
+    return decode(pattern_, pos_);
+  }
+
+  Node alternation(size_t depth) {
+    if (depth > kMaxDepth) {
+      invalid("groups nested too deeply");
+    }
+
+    Node res{.kind = Node::ALTERNATION};
+    res.children.push_back(sequence(depth));
+    while (accept('|')) {
+      res.children.push_back(sequence(depth));
+    }
+
+    if (res.children.size() == 1) {
+      return std::move(res.children[0]);
+    }
+
+    return res;
+  }
+
+  Node sequence(size_t depth) {
+    Node res{.kind = Node::SEQUENCE};
+    while (!eof() && peek() != '|' && peek() != ')') {
+      res.children.push_back(quantified(atom(depth)));
+    }
+
+    return res;
+  }
+
+  Node quantified(Node atom) {
+    uint32_t min;
+    uint32_t max;
+    if (accept('*')) {
+      min = 0;
+      max = kUnbounded;
+    } else if (accept('+')) {
+      min = 1;
+      max = kUnbounded;
+    } else if (accept('?')) {
+      min = 0;
+      max = 1;
+    } else if (!braces(min, max)) {
+      return atom;
+    }
+
+    // Laziness changes which match is found, not whether there is one.
+    accept('?');
+    if (atom.kind == Node::ASSERTION || starts_quantifier()) {
+      invalid("nothing to repeat");
+    } else if (min > max) {
+      invalid("numbers out of order in {} quantifier");
+    }
+
+    // Copies of a node that emits nothing would not count towards
+    // kMaxProgram, so ((?:){65536}){65536} would spin in emit. Repeated, it
+    // still only matches the empty string.
+    if (emits_nothing(atom)) {
+      return atom;
+    }
+
+    Node res{.kind = Node::REPEAT, .min = min, .max = max};
+    res.children.push_back(std::move(atom));
+    return res;
+  }
+
+  static bool emits_nothing(const Node& node) {
+    switch (node.kind) {
+      case Node::SEQUENCE:
+        return std::all_of(node.children.begin(), node.children.end(),
+                           emits_nothing);
+      case Node::REPEAT:
+        return node.max == 0 || emits_nothing(node.children[0]);
+      default:
+        return false;
+    }
+  }
+
+  bool starts_quantifier() {
+    size_t start = pos_;
+    uint32_t min;
+    uint32_t max;
+    bool res = peek() == '*' || peek() == '+' || peek() == '?' ||
+               braces(min, max);
+    pos_ = start;
+    return res;
+  }
+
+  // Reads a {n}, {n,} or {n,m} quantifier. Anything else is left unread, and
+  // a "{" that starts no quantifier is a literal.
+  bool braces(uint32_t& min, uint32_t& max) {
+    size_t start = pos_;
+    if (!accept('{') || !number(min)) {
+      pos_ = start;
+      return false;
+    }
+
+    max = min;
+    if (accept(',') && !number(max)) {
+      max = kUnbounded;
+    }
+
+    if (!accept('}')) {
+      pos_ = start;
+      return false;
+    }
+
+    return true;
+  }
+
+  // Reads decimal digits, clamping the value to the program size limit.
+  bool number(uint32_t& n) {
+    size_t start = pos_;
+    n = 0;
+    while (peek() >= '0' && peek() <= '9') {
+      n = std::min(n * 10 + uint32_t(pattern_[pos_++] - '0'), kMaxProgram);
+    }
+
+    return pos_ > start;
+  }
+
+  Node atom(size_t depth) {
+    if (starts_quantifier()) {
+      invalid("nothing to repeat");
+    } else if (accept('(')) {
+      return group(depth);
+    } else if (accept('[')) {
+      return char_class();
+    } else if (accept('.')) {
+      return class_node(dot());
+    } else if (accept('^')) {
+      return Node{.kind = Node::ASSERTION, .op = Inst::BEGIN};
+    } else if (accept('$')) {
+      return Node{.kind = Node::ASSERTION, .op = Inst::END};
+    } else if (accept('\\')) {
+      return escape();
+    }
+
+    char32_t c = next();
+    return class_node({{c, c}});
+  }
+
+  Node group(size_t depth) {
+    if (accept('?')) {
+      if (accept('<') && peek() != '=' && peek() != '!') {
+        // A named group; only backreferences would use the name.
+        while (!accept('>')) {
+          next();
+        }
+      } else if (!accept(':')) {
+        invalid("lookaround is not supported");
+      }
+    }
+
+    Node res = alternation(depth + 1);
+    if (!accept(')')) {
+      invalid("missing ')'");
+    }
+
+    return res;
+  }
+
+  Node escape() {
+    if (accept('b')) {
+      return Node{.kind = Node::ASSERTION, .op = Inst::WORD_BOUNDARY};
+    } else if (accept('B')) {
+      return Node{.kind = Node::ASSERTION, .op = Inst::NOT_WORD_BOUNDARY};
+    } else if ((peek() >= '1' && peek() <= '9') || peek() == 'k') {
+      invalid("backreferences are not supported");
+    }
+
+    return class_node(escaped(next()));
+  }
+
+  // The characters an escape `\c` stands for, with the backslash read.
+  Ranges escaped(char32_t c) {
+    switch (c) {
+      case 'd':
+        return digit();
+      case 'D':
+        return complement(digit());
+      case 'w':
+        return word();
+      case 'W':
+        return complement(word());
+      case 's':
+        return space();
+      case 'S':
+        return complement(space());
+      case 't':
+        return {{'\t', '\t'}};
+      case 'n':
+        return {{'\n', '\n'}};
+      case 'r':
+        return {{'\r', '\r'}};
+      case 'f':
+        return {{'\f', '\f'}};
+      case 'v':
+        return {{'\v', '\v'}};
+      case '0':
+        if (peek() >= '0' && peek() <= '9') {
+          invalid("octal escapes are not supported");
+        }
+
+        return {{0, 0}};
+      case 'c': {
+        char letter = peek();
+        if (!((letter >= 'a' && letter <= 'z') ||
+              (letter >= 'A' && letter <= 'Z'))) {
+          invalid("invalid \\c escape");
+        }
+
+        pos_++;
+        char32_t control = char32_t(letter) % 32;
+        return {{control, control}};
+      }
+      case 'x': {
+        char32_t unit = hex(2);
+        return {{unit, unit}};
+      }
+      case 'u': {
+        char32_t unit = hex(4);
+        // A surrogate pair spelled as two escapes is one code point.
+        if (unit >= 0xd800 && unit <= 0xdbff &&
+            pattern_.substr(pos_).starts_with("\\u")) {
+          size_t start = pos_;
+          pos_ += 2;
+          char32_t low = hex(4);
+          if (low >= 0xdc00 && low <= 0xdfff) {
+            unit = 0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00);
+          } else {
+            pos_ = start;
+          }
+        }
+
+        return {{unit, unit}};
+      }
+      default:
+        return {{c, c}};
+    }
+  }
+
+  char32_t hex(size_t digits) {
+    char32_t res = 0;
+    for (size_t i = 0; i < digits; i++) {
+      char c = peek();
+      uint32_t value;
+      if (c >= '0' && c <= '9') {
+        value = uint32_t(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        value = uint32_t(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        value = uint32_t(c - 'A' + 10);
+      } else {
+        invalid("invalid hexadecimal escape");
+      }
+
+      pos_++;
+      res = res << 4 | value;
+    }
+
+    return res;
+  }
+
+  Node char_class() {
+    bool negate = accept('^');
+    Ranges ranges;
+    while (!accept(']')) {
+      Ranges lo = class_atom();
+      if (peek() == '-' && pos_ + 1 < pattern_.size() &&
+          pattern_[pos_ + 1] != ']') {
+        pos_++;
+        Ranges hi = class_atom();
+        if (is_single(lo) && is_single(hi)) {
+          if (lo[0].first > hi[0].first) {
+            invalid("range out of order in character class");
+          }
+
+          ranges.emplace_back(lo[0].first, hi[0].first);
+          continue;
+        }
+
+        // A class escape at either end makes the "-" a literal.
+        ranges.emplace_back('-', '-');
+        ranges.insert(ranges.end(), hi.begin(), hi.end());
+      }
+
+      ranges.insert(ranges.end(), lo.begin(), lo.end());
+    }
+
+    return class_node(negate ? complement(ranges) : normalize(ranges));
+  }
+
+  Ranges class_atom() {
+    if (eof()) {
+      invalid("missing ']'");
+    } else if (!accept('\\')) {
+      char32_t c = next();
+      return {{c, c}};
+    } else if (accept('b')) {
+      return {{'\b', '\b'}};
+    } else if (accept('-')) {
+      return {{'-', '-'}};
+    }
+
+    return escaped(next());
+  }
+
+  Node class_node(Ranges ranges) {
+    auto index = static_cast<uint32_t>(regex_.classes_.size());
+    regex_.classes_.push_back(Class{.ranges = normalize(std::move(ranges))});
+    return Node{.kind = Node::CLASS, .index = index};
+  }
+
+  uint32_t push(Inst inst) {
+    if (regex_.program_.size() >= kMaxProgram) {
+      invalid("pattern too large");
+    }
+
+    regex_.program_.push_back(inst);
+    return static_cast<uint32_t>(regex_.program_.size() - 1);
+  }
+
+  uint32_t here() const {
+    return static_cast<uint32_t>(regex_.program_.size());
+  }
+
+  void emit(const Node& node) {
+    std::vector<Inst>& program = regex_.program_;
+    switch (node.kind) {
+      case Node::CLASS:
+        push({.op = Inst::CLASS, .arg = node.index});
+        break;
+      case Node::ASSERTION:
+        push({.op = node.op});
+        break;
+      case Node::SEQUENCE:
+        for (const Node& child : node.children) {
+          emit(child);
+        }
+        break;
+      case Node::ALTERNATION: {
+        // Each branch but the last is tried through a SPLIT and jumps to
+        // the end when it is done.
+        std::vector<uint32_t> jumps;
+        for (size_t i = 0; i + 1 < node.children.size(); i++) {
+          uint32_t split = push({.op = Inst::SPLIT});
+          program[split].arg = here();
+          emit(node.children[i]);
+          jumps.push_back(push({.op = Inst::JUMP}));
+          program[split].alt = here();
+        }
+
+        emit(node.children.back());
+        for (uint32_t jump : jumps) {
+          program[jump].arg = here();
+        }
+        break;
+      }
+      case Node::REPEAT: {
+        const Node& child = node.children[0];
+        for (uint32_t i = 0; i < node.min; i++) {
+          emit(child);
+        }
+
+        if (node.max == kUnbounded) {
+          uint32_t loop = push({.op = Inst::SPLIT});
+          program[loop].arg = here();
+          emit(child);
+          push({.op = Inst::JUMP, .arg = loop});
+          program[loop].alt = here();
+          break;
+        }
+
+        // Optional copies, any of which may skip to the end.
+        std::vector<uint32_t> skips;
+        for (uint32_t i = node.min; i < node.max; i++) {
+          skips.push_back(push({.op = Inst::SPLIT}));
+          program[skips.back()].arg = here();
+          emit(child);
+        }
+
+        for (uint32_t skip : skips) {
+          program[skip].alt = here();
+        }
+        break;
+      }
+    }
+  }
+
+  std::string_view pattern_;
+  size_t pos_ = 0;
+  Regex& regex_;
+};
+
+bool Regex::Class::contains(char32_t c) const {
+  auto it = std::upper_bound(
+      ranges.begin(), ranges.end(), c,
+      [](char32_t c, const auto& range) { return c < range.first; });
+  return it != ranges.begin() && c <= std::prev(it)->second;
+}
+
+Regex::Regex(std::string_view pattern) { Compiler(pattern, *this).run(); }
+
+bool Regex::search(std::string_view s) const {
+  // Threads are program counters waiting at a CLASS. `seen` records the
+  // last step at which each counter was reached, so a step visits each
+  // instruction at most once however the program loops.
+  std::vector<uint32_t> threads;
+  std::vector<uint32_t> next;
+  std::vector<size_t> seen(program_.size(), 0);
+  std::vector<uint32_t> stack;
+  size_t step = 1;
+
+  // Follows the program from `start` up to the CLASS instructions it can
+  // reach without input, between characters `before` and `after`. Returns
+  // true once a MATCH is reached.
+  auto add = [&](std::vector<uint32_t>& list, uint32_t start, char32_t before,
+                 char32_t after) {
+    stack.assign(1, start);
+    while (!stack.empty()) {
+      uint32_t pc = stack.back();
+      stack.pop_back();
+      if (seen[pc] == step) {
+        continue;
+      }
+
+      seen[pc] = step;
+      const Inst& inst = program_[pc];
+      switch (inst.op) {
+        case Inst::CLASS:
+          list.push_back(pc);
+          break;
+        case Inst::SPLIT:
+          stack.push_back(inst.alt);
+          stack.push_back(inst.arg);
+          break;
+        case Inst::JUMP:
+          stack.push_back(inst.arg);
+          break;
+        case Inst::BEGIN:
+          if (before == kNone) {
+            stack.push_back(pc + 1);
+          }
+          break;
+        case Inst::END:
+          if (after == kNone) {
+            stack.push_back(pc + 1);
+          }
+          break;
+        case Inst::WORD_BOUNDARY:
+        case Inst::NOT_WORD_BOUNDARY:
+          if ((is_word(before) != is_word(after)) ==
+              (inst.op == Inst::WORD_BOUNDARY)) {
+            stack.push_back(pc + 1);
+          }
+          break;
+        case Inst::MATCH:
+          return true;
+      }
+    }
+
+    return false;
+  };
+
+  const bool anchored = program_[0].op == Inst::BEGIN;
+  size_t i = 0;
+  size_t end = 0;
+  char32_t before = kNone;
+  char32_t at = s.empty() ? kNone : decode(s, end);
+  while (true) {
+    // The search is unanchored, so a new attempt starts at every position.
+    if ((!anchored || i == 0) && add(threads, 0, before, at)) {
+      return true;
+    } else if (at == kNone || (anchored && threads.empty())) {
+      return false;
+    }
+
+    size_t following = end;
+    char32_t after = end < s.size() ? decode(s, following) : kNone;
+    step++;
+    next.clear();
+    for (uint32_t pc : threads) {
+      if (classes_[program_[pc].arg].contains(at) &&
+          add(next, pc + 1, at, after)) {
+        return true;
+      }
+    }
+
+    std::swap(threads, next);
+    before = at;
+    at = after;
+    i = end;
+    end = following;
+  }
+}
+
+}  // namespace json
+}  // namespace warren
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>  // size_t
+#include <cstdint>  // uint32_t
+#include <string_view>
+#include <utility>  // pair
+#include <vector>
+
+namespace warren {
+namespace json {
+
+// A regular expression in the ECMA-262 subset that JSON Schema recommends
+// for "pattern": literals, ".", classes with ranges and \d \w \s, groups,
+// alternation, greedy or lazy quantifiers including {n,m}, ^, $ and \b.
+// Backreferences and lookaround are rejected.
+//
+// Matching simulates the compiled NFA over all threads at once (a Pike VM),
+// so it never backtracks: time is linear in the input for a given pattern
+// and the stack stays bounded however long the input is. Patterns and
+// inputs are UTF-8 and matched by code point.
+class Regex {
+ public:
+  // Throws std::invalid_argument if `pattern` is malformed, unsupported or
+  // compiles to too large a program.
+  explicit Regex(std::string_view pattern);
+
+  // Whether the pattern matches anywhere in `s`, like RegExp.prototype.test.
+  bool search(std::string_view s) const;
+
+ private:
+  struct Class {
+    // Sorted, disjoint, inclusive code point ranges.
+    std::vector<std::pair<char32_t, char32_t>> ranges;
+
+    bool contains(char32_t c) const;
+  };
+
+  struct Inst {
+    enum Op : uint8_t {
+      CLASS,  // consumes a code point in classes_[arg]
+      SPLIT,  // continues at both `arg` and `alt`
+      JUMP,   // continues at `arg`
+      BEGIN,
+      END,
+      WORD_BOUNDARY,
+      NOT_WORD_BOUNDARY,
+      MATCH
+    };
+
+    Op op;
+    uint32_t arg = 0;
+    uint32_t alt = 0;
+  };
+
+  class Compiler;
+
+  std::vector<Class> classes_;
+  std::vector<Inst> program_;
+};
+
+}  // namespace json
+}  // namespace warren
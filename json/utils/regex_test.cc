@@ -0,0 +1,126 @@
+#include "warren/json/utils/regex.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+bool search(const char* pattern, const std::string& s) {
+  return Regex(pattern).search(s);
+}
+
+TEST(RegexTest, Literals) {
+  EXPECT_TRUE(search("abc", "xxabcxx"));
+  EXPECT_FALSE(search("abc", "xxabxcx"));
+  EXPECT_TRUE(search("", ""));
+  EXPECT_TRUE(search("", "abc"));
+  EXPECT_TRUE(search("a\\.b", "a.b"));
+  EXPECT_FALSE(search("a\\.b", "axb"));
+  EXPECT_TRUE(search("\\x41\\u00e9", "A\xc3\xa9"));
+  EXPECT_TRUE(search("\\ud83d\\ude00", "\xf0\x9f\x98\x80"));
+  EXPECT_TRUE(search("a{", "a{"));
+  EXPECT_TRUE(search("a{,2}", "a{,2}"));
+}
+
+TEST(RegexTest, Anchors) {
+  EXPECT_TRUE(search("^ab$", "ab"));
+  EXPECT_FALSE(search("^ab$", "abc"));
+  EXPECT_FALSE(search("^ab$", "cab"));
+  EXPECT_TRUE(search("b$", "ab"));
+  EXPECT_TRUE(search("\\bfoo\\b", "a foo b"));
+  EXPECT_FALSE(search("\\bfoo\\b", "afoo"));
+  EXPECT_TRUE(search("\\Boo", "foo"));
+  EXPECT_FALSE(search("\\Bfoo", "foo"));
+}
+
+TEST(RegexTest, Classes) {
+  EXPECT_TRUE(search("^[a-c]+$", "abcba"));
+  EXPECT_FALSE(search("^[a-c]+$", "abd"));
+  EXPECT_TRUE(search("^[^a-c]$", "d"));
+  EXPECT_FALSE(search("^[^a-c]$", "b"));
+  EXPECT_TRUE(search("^\\d\\w\\s$", "7_ "));
+  EXPECT_FALSE(search("\\d", "abc"));
+  EXPECT_TRUE(search("^\\D\\W\\S$", "a-b"));
+  EXPECT_TRUE(search("^[\\d-]+$", "1-2"));
+  EXPECT_TRUE(search("^[\\b]$", "\b"));
+  EXPECT_TRUE(search("^[-a]+$", "a-"));
+  EXPECT_FALSE(search("[]", "a"));
+  EXPECT_TRUE(search("^[^]$", "\n"));
+  EXPECT_TRUE(search("^\\s$", "\xe3\x80\x80"));
+}
+
+TEST(RegexTest, Dot) {
+  EXPECT_TRUE(search("^.$", "\xc3\xa9"));
+  EXPECT_TRUE(search("^.$", "\xf0\x9f\x98\x80"));
+  EXPECT_FALSE(search("^.$", "\n"));
+  EXPECT_FALSE(search("^..$", "\xc3\xa9"));
+}
+
+TEST(RegexTest, Quantifiers) {
+  EXPECT_TRUE(search("^a*$", ""));
+  EXPECT_TRUE(search("^a+$", "aaa"));
+  EXPECT_FALSE(search("^a+$", ""));
+  EXPECT_TRUE(search("^ab?c$", "ac"));
+  EXPECT_TRUE(search("^a{2}$", "aa"));
+  EXPECT_FALSE(search("^a{2}$", "aaa"));
+  EXPECT_TRUE(search("^a{2,}$", "aaaa"));
+  EXPECT_FALSE(search("^a{2,}$", "a"));
+  EXPECT_TRUE(search("^a{1,3}$", "aaa"));
+  EXPECT_FALSE(search("^a{1,3}$", "aaaa"));
+  EXPECT_TRUE(search("^a+?b*?$", "aab"));
+  EXPECT_TRUE(search("^(?:a*)*$", "aaa"));
+  EXPECT_TRUE(search("^(a|)+$", "aa"));
+}
+
+TEST(RegexTest, Groups) {
+  EXPECT_TRUE(search("^(ab|cd)+$", "abcdab"));
+  EXPECT_FALSE(search("^(ab|cd)+$", "abc"));
+  EXPECT_TRUE(search("^(?:x|y)z$", "yz"));
+  EXPECT_TRUE(search("^(?<name>a)b$", "ab"));
+  EXPECT_TRUE(search("a|^b", "cb a"));
+  EXPECT_FALSE(search("x|^b", "cb"));
+}
+
+TEST(RegexTest, LongInputs) {
+  std::string s(200000, 'a');
+  EXPECT_TRUE(search("^(a|b)*$", s));
+  EXPECT_TRUE(search("^(a|aa)*$", s));
+  EXPECT_FALSE(search("^(a*)*b$", s));
+  EXPECT_FALSE(search("^(a|a)*c", s + "b"));
+}
+
+TEST(RegexTest, EmptyRepeats) {
+  EXPECT_TRUE(search("^((?:){65536}){65536}$", ""));
+  EXPECT_TRUE(search("^a(?:(?:(?:){65536}){65536}){65536}b$", "ab"));
+  EXPECT_FALSE(search("^(?:(?:)(?:){3}){65536}$", "a"));
+  EXPECT_TRUE(search("^(?:a{0}){65536}b{0,}$", "bb"));
+}
+
+TEST(RegexTest, Malformed) {
+  EXPECT_THROW(Regex("("), std::invalid_argument);
+  EXPECT_THROW(Regex(")"), std::invalid_argument);
+  EXPECT_THROW(Regex("[a"), std::invalid_argument);
+  EXPECT_THROW(Regex("[b-a]"), std::invalid_argument);
+  EXPECT_THROW(Regex("*a"), std::invalid_argument);
+  EXPECT_THROW(Regex("a**"), std::invalid_argument);
+  EXPECT_THROW(Regex("^*"), std::invalid_argument);
+  EXPECT_THROW(Regex("a{2,1}"), std::invalid_argument);
+  EXPECT_THROW(Regex("a\\"), std::invalid_argument);
+  EXPECT_THROW(Regex("\\x4"), std::invalid_argument);
+  EXPECT_THROW(Regex("(a)\\1"), std::invalid_argument);
+  EXPECT_THROW(Regex("(?=a)"), std::invalid_argument);
+  EXPECT_THROW(Regex("(?<!a)b"), std::invalid_argument);
+  EXPECT_THROW(Regex(std::string(1000, '(') + std::string(1000, ')')),
+               std::invalid_argument);
+  EXPECT_THROW(Regex("(a{1000}){1000}"), std::invalid_argument);
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
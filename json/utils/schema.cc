@@ -0,0 +1,887 @@
+#include "warren/json/utils/schema.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint32_t, uint64_t
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>  // move, pair
+#include <vector>
+
+#include "warren/json/parse/lexer.h"
+#include "warren/json/parse/parser.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/hash.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/utils/patch.h"
+#include "warren/json/utils/regex.h"
+#include "warren/json/value.h"
+
+namespace {
+
+using warren::json::SchemaException;
+using warren::json::Value;
+
+constexpr uint8_t kNull = 1 << 0;
+constexpr uint8_t kBoolean = 1 << 1;
+constexpr uint8_t kInteger = 1 << 2;
+constexpr uint8_t kNumber = 1 << 3;
+constexpr uint8_t kString = 1 << 4;
+constexpr uint8_t kArray = 1 << 5;
+constexpr uint8_t kObject = 1 << 6;
+constexpr uint8_t kAnyType = 0x7f;
+// Integers are numbers too.
+constexpr uint8_t kWholeNumber = kInteger | kNumber;
+
+// Assertion keywords outside the supported subset. Ignoring them would let
+// invalid documents through.
+constexpr std::string_view kUnsupported[] = {
+    "$dynamicRef",      "contains",          "dependentRequired",
+    "dependentSchemas", "else",              "if",
+    "maxContains",      "minContains",       "patternProperties",
+    "propertyNames",    "then",              "unevaluatedItems",
+    "unevaluatedProperties"};
+
+uint8_t type_bit(std::string_view name) {
+  if (name == "null") {
+    return kNull;
+  } else if (name == "boolean") {
+    return kBoolean;
+  } else if (name == "integer") {
+    return kInteger;
+  } else if (name == "number") {
+    return kWholeNumber;
+  } else if (name == "string") {
+    return kString;
+  } else if (name == "array") {
+    return kArray;
+  } else if (name == "object") {
+    return kObject;
+  }
+
+  throw SchemaException("unknown type: " + std::string(name));
+}
+
+// An instance matches a type mask if any of its bits are set.
+uint8_t type_bits(const Value& value) {
+  if (value.is_null()) {
+    return kNull;
+  } else if (value.is_boolean()) {
+    return kBoolean;
+  } else if (value.is_integral()) {
+    return kWholeNumber;
+  } else if (value.is_double()) {
+    double d = value;
+    return std::isfinite(d) && d == std::floor(d) ? kWholeNumber : kNumber;
+  } else if (value.is_string()) {
+    return kString;
+  } else if (value.is_array()) {
+    return kArray;
+  } else if (value.is_object()) {
+    return kObject;
+  }
+
+  throw warren::json::BadAccessException(
+      "raw value must be expanded to be validated");
+}
+
+double number(const Value& value) {
+  return value.is_integral() ? double(int32_t(value)) : double(value);
+}
+
+// Length in code points, as the spec counts it.
+size_t length(const std::string& s) {
+  return static_cast<size_t>(std::count_if(s.begin(), s.end(), [](char c) {
+    return (static_cast<uint8_t>(c) & 0xc0) != 0x80;
+  }));
+}
+
+bool unique(const Value& array) {
+  std::vector<std::pair<uint64_t, const Value*>> items;
+  items.reserve(array.size());
+  for (const Value& item : array) {
+    items.emplace_back(warren::json::hash(item), &item);
+  }
+
+  std::sort(items.begin(), items.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  });
+  for (size_t i = 0; i < items.size(); i++) {
+    for (size_t j = i + 1; j < items.size() && items[j].first == items[i].first;
+         j++) {
+      if (*items[i].second == *items[j].second) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+// Decodes the %XX escapes of a URI fragment (RFC 3986 2.1), or returns
+// nullopt if one is malformed.
+std::optional<std::string> percent_decode(std::string_view s) {
+  auto hex = [](char c) -> int {
+    if (c >= '0' && c <= '9') {
+      return c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+      return c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+      return c - 'a' + 10;
+    }
+
+    return -1;
+  };
+
+  std::string res;
+  res.reserve(s.size());
+  for (size_t i = 0; i < s.size(); i++) {
+    if (s[i] != '%') {
+      res += s[i];
+      continue;
+    }
+
+    int hi = i + 2 < s.size() ? hex(s[i + 1]) : -1;
+    int lo = i + 2 < s.size() ? hex(s[i + 2]) : -1;
+    if (hi < 0 || lo < 0) {
+      return std::nullopt;
+    }
+
+    res += static_cast<char>(hi << 4 | lo);
+    i += 2;
+  }
+
+  return res;
+}
+
+void append_pointer_token(std::string& pointer, std::string_view token) {
+  pointer += '/';
+  for (char c : token) {
+    if (c == '~') {
+      pointer += "~0";
+    } else if (c == '/') {
+      pointer += "~1";
+    } else {
+      pointer += c;
+    }
+  }
+}
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+struct Schema::Node {
+  bool never = false;
+  uint8_t types = kAnyType;
+  std::optional<array_t> enum_values;
+  std::optional<Value> const_value;
+
+  std::optional<double> minimum;
+  std::optional<double> maximum;
+  std::optional<double> exclusive_minimum;
+  std::optional<double> exclusive_maximum;
+  std::optional<double> multiple_of;
+
+  std::optional<size_t> min_length;
+  std::optional<size_t> max_length;
+  std::optional<Regex> pattern;
+
+  std::vector<uint32_t> prefix_items;
+  std::optional<uint32_t> items;
+  std::optional<size_t> min_items;
+  std::optional<size_t> max_items;
+  bool unique_items = false;
+
+  // Sorted by name for binary search.
+  std::vector<std::pair<std::string, uint32_t>> properties;
+  // Sorted and deduplicated, to merge against an object's ordered members.
+  std::vector<std::string> required;
+  std::optional<uint32_t> additional_properties;
+  std::optional<size_t> min_properties;
+  std::optional<size_t> max_properties;
+
+  std::vector<uint32_t> all_of;
+  std::vector<uint32_t> any_of;
+  std::vector<uint32_t> one_of;
+  std::optional<uint32_t> not_;
+  std::optional<uint32_t> ref;
+
+  // Whether the node asserts anything itself, as opposed to only through
+  // allOf and $ref.
+  bool asserts = false;
+  // The asserting nodes among this one and all reached from it through allOf
+  // and $ref, which apply to the same instance.
+  std::vector<uint32_t> applied;
+};
+
+class Schema::Compiler {
+ public:
+  Compiler(const Value& root, std::vector<Node>& nodes)
+      : root_(root), nodes_(nodes) {}
+
+  void run() {
+    compile(root_);
+    // $ref targets are compiled once the referring schema is done, which
+    // also breaks reference cycles.
+    while (!refs_.empty()) {
+      auto [index, ref] = std::move(refs_.back());
+      refs_.pop_back();
+      if (!ref.starts_with('#')) {
+        throw SchemaException("unsupported $ref: " + ref);
+      }
+
+      // The fragment is a JSON Pointer in URI encoding.
+      std::optional<std::string> pointer =
+          percent_decode(std::string_view(ref).substr(1));
+      const Value* target = pointer ? resolve(root_, *pointer) : nullptr;
+      if (target == nullptr) {
+        throw SchemaException("unresolvable $ref: " + ref);
+      }
+
+      uint32_t compiled = compile(*target);
+      nodes_[index].ref = compiled;
+    }
+
+    for (uint32_t i = 0; i < nodes_.size(); i++) {
+      nodes_[i].applied = flatten(i);
+    }
+  }
+
+ private:
+  uint32_t compile(const Value& schema) {
+    if (auto it = compiled_.find(&schema); it != compiled_.end()) {
+      return it->second;
+    }
+
+    uint32_t index = static_cast<uint32_t>(nodes_.size());
+    compiled_.emplace(&schema, index);
+    nodes_.emplace_back();
+
+    Node node;
+    if (schema.is_boolean()) {
+      node.never = !bool(schema);
+      node.asserts = node.never;
+      nodes_[index] = std::move(node);
+      return index;
+    } else if (!schema.is_object()) {
+      throw SchemaException("schema must be an object or a boolean");
+    }
+
+    for (auto it = schema.begin(); it != schema.end(); ++it) {
+      keyword(node, index, it.key(), *it);
+    }
+
+    node.asserts =
+        node.never || node.types != kAnyType || node.enum_values ||
+        node.const_value || node.minimum || node.maximum ||
+        node.exclusive_minimum || node.exclusive_maximum ||
+        node.multiple_of || node.min_length || node.max_length ||
+        node.pattern || !node.prefix_items.empty() || node.items ||
+        node.min_items || node.max_items || node.unique_items ||
+        !node.properties.empty() || !node.required.empty() ||
+        node.additional_properties || node.min_properties ||
+        node.max_properties || !node.any_of.empty() || !node.one_of.empty() ||
+        node.not_;
+    nodes_[index] = std::move(node);
+    return index;
+  }
+
+  void keyword(Node& node, uint32_t index, const std::string& key,
+               const Value& value) {
+    if (key == "type") {
+      if (value.is_string()) {
+        node.types = type_bit(static_cast<const std::string&>(value));
+      } else {
+        node.types = 0;
+        for (const Value& name : array(key, value)) {
+          node.types |= type_bit(string(key, name));
+        }
+      }
+    } else if (key == "enum") {
+      node.enum_values = static_cast<const array_t&>(array(key, value));
+    } else if (key == "const") {
+      node.const_value = value;
+    } else if (key == "minimum") {
+      node.minimum = number(key, value);
+    } else if (key == "maximum") {
+      node.maximum = number(key, value);
+    } else if (key == "exclusiveMinimum") {
+      node.exclusive_minimum = number(key, value);
+    } else if (key == "exclusiveMaximum") {
+      node.exclusive_maximum = number(key, value);
+    } else if (key == "multipleOf") {
+      node.multiple_of = number(key, value);
+      if (*node.multiple_of <= 0) {
+        throw SchemaException("multipleOf must be positive");
+      }
+    } else if (key == "minLength") {
+      node.min_length = count(key, value);
+    } else if (key == "maxLength") {
+      node.max_length = count(key, value);
+    } else if (key == "pattern") {
+      try {
+        node.pattern.emplace(string(key, value));
+      } catch (const std::invalid_argument&) {
+        throw SchemaException("invalid pattern: " + string(key, value));
+      }
+    } else if (key == "prefixItems") {
+      node.prefix_items = schemas(key, value);
+    } else if (key == "items") {
+      node.items = compile(value);
+    } else if (key == "minItems") {
+      node.min_items = count(key, value);
+    } else if (key == "maxItems") {
+      node.max_items = count(key, value);
+    } else if (key == "uniqueItems") {
+      node.unique_items = boolean(key, value);
+    } else if (key == "properties") {
+      if (!value.is_object()) {
+        throw SchemaException("properties must be an object");
+      }
+
+      // Object members iterate in key order already.
+      for (auto it = value.begin(); it != value.end(); ++it) {
+        node.properties.emplace_back(it.key(), compile(*it));
+      }
+    } else if (key == "required") {
+      for (const Value& name : array(key, value)) {
+        node.required.push_back(string(key, name));
+      }
+
+      std::sort(node.required.begin(), node.required.end());
+      node.required.erase(
+          std::unique(node.required.begin(), node.required.end()),
+          node.required.end());
+    } else if (key == "additionalProperties") {
+      node.additional_properties = compile(value);
+    } else if (key == "minProperties") {
+      node.min_properties = count(key, value);
+    } else if (key == "maxProperties") {
+      node.max_properties = count(key, value);
+    } else if (key == "allOf") {
+      node.all_of = schemas(key, value);
+    } else if (key == "anyOf") {
+      node.any_of = schemas(key, value);
+    } else if (key == "oneOf") {
+      node.one_of = schemas(key, value);
+    } else if (key == "not") {
+      node.not_ = compile(value);
+    } else if (key == "$ref") {
+      refs_.emplace_back(index, string(key, value));
+    } else if (std::find(std::begin(kUnsupported), std::end(kUnsupported),
+                         key) != std::end(kUnsupported)) {
+      throw SchemaException("unsupported keyword: " + key);
+    }
+  }
+
+  // This node and everything it pulls in through allOf and $ref, keeping
+  // only nodes that assert something.
+  std::vector<uint32_t> flatten(uint32_t index) const {
+    std::vector<uint32_t> applied;
+    std::vector<uint32_t> pending = {index};
+    std::vector<uint32_t> seen;
+    while (!pending.empty()) {
+      uint32_t curr = pending.back();
+      pending.pop_back();
+      if (std::find(seen.begin(), seen.end(), curr) != seen.end()) {
+        continue;
+      }
+
+      seen.push_back(curr);
+      const Node& node = nodes_[curr];
+      if (node.asserts) {
+        applied.push_back(curr);
+      }
+
+      if (node.ref) {
+        pending.push_back(*node.ref);
+      }
+
+      pending.insert(pending.end(), node.all_of.rbegin(), node.all_of.rend());
+    }
+
+    return applied;
+  }
+
+  std::vector<uint32_t> schemas(const std::string& key, const Value& value) {
+    if (!value.is_array() || value.empty()) {
+      throw SchemaException(key + " must be a non-empty array");
+    }
+
+    std::vector<uint32_t> res;
+    for (const Value& schema : value) {
+      res.push_back(compile(schema));
+    }
+
+    return res;
+  }
+
+  static const Value& array(const std::string& key, const Value& value) {
+    if (!value.is_array()) {
+      throw SchemaException(key + " must be an array");
+    }
+
+    return value;
+  }
+
+  static std::string string(const std::string& key, const Value& value) {
+    if (!value.is_string()) {
+      throw SchemaException(key + " must be a string");
+    }
+
+    return value;
+  }
+
+  static double number(const std::string& key, const Value& value) {
+    if (!value.is_number()) {
+      throw SchemaException(key + " must be a number");
+    }
+
+    return ::number(value);
+  }
+
+  static size_t count(const std::string& key, const Value& value) {
+    double n = value.is_number() ? ::number(value) : -1;
+    if (n < 0 || n != std::floor(n)) {
+      throw SchemaException(key + " must be a non-negative integer");
+    }
+
+    // Larger counts can never be reached, and casting them is undefined.
+    constexpr size_t kMax = std::numeric_limits<size_t>::max();
+    if (n >= static_cast<double>(kMax)) {
+      return kMax;
+    }
+
+    return static_cast<size_t>(n);
+  }
+
+  static bool boolean(const std::string& key, const Value& value) {
+    if (!value.is_boolean()) {
+      throw SchemaException(key + " must be a boolean");
+    }
+
+    return value;
+  }
+
+  const Value& root_;
+  std::vector<Node>& nodes_;
+  std::unordered_map<const Value*, uint32_t> compiled_;
+  std::vector<std::pair<uint32_t, std::string>> refs_;
+};
+
+// Walks an instance against sets of applied nodes. Each node's own keywords
+// are checked against the whole value; children are then checked against
+// the union of the subschemas the nodes assign them, and skipped when no
+// subschema constrains them.
+class Schema::Validator {
+ public:
+  explicit Validator(const std::vector<Node>& nodes) : nodes_(nodes) {}
+
+  // Returns the keyword `value` fails, or nullptr. The value's children are
+  // not visited except through anyOf, oneOf and not.
+  const char* check(const Node& node, const Value& value) const {
+    if (node.never) {
+      return "false";
+    } else if ((node.types & type_bits(value)) == 0) {
+      return "type";
+    } else if (node.enum_values &&
+               std::find(node.enum_values->begin(), node.enum_values->end(),
+                         value) == node.enum_values->end()) {
+      return "enum";
+    } else if (node.const_value && !(*node.const_value == value)) {
+      return "const";
+    }
+
+    if (value.is_number()) {
+      double n = ::number(value);
+      if (node.minimum && n < *node.minimum) {
+        return "minimum";
+      } else if (node.maximum && n > *node.maximum) {
+        return "maximum";
+      } else if (node.exclusive_minimum && n <= *node.exclusive_minimum) {
+        return "exclusiveMinimum";
+      } else if (node.exclusive_maximum && n >= *node.exclusive_maximum) {
+        return "exclusiveMaximum";
+      } else if (node.multiple_of) {
+        double quotient = n / *node.multiple_of;
+        if (!std::isfinite(quotient) || quotient != std::floor(quotient)) {
+          return "multipleOf";
+        }
+      }
+    } else if (value.is_string()) {
+      const std::string& s = value;
+      if (node.min_length || node.max_length) {
+        size_t n = length(s);
+        if (node.min_length && n < *node.min_length) {
+          return "minLength";
+        } else if (node.max_length && n > *node.max_length) {
+          return "maxLength";
+        }
+      }
+
+      if (node.pattern && !node.pattern->search(s)) {
+        return "pattern";
+      }
+    } else if (value.is_array()) {
+      if (node.min_items && value.size() < *node.min_items) {
+        return "minItems";
+      } else if (node.max_items && value.size() > *node.max_items) {
+        return "maxItems";
+      } else if (node.unique_items && !unique(value)) {
+        return "uniqueItems";
+      }
+    } else if (value.is_object()) {
+      if (node.min_properties && value.size() < *node.min_properties) {
+        return "minProperties";
+      } else if (node.max_properties && value.size() > *node.max_properties) {
+        return "maxProperties";
+      } else if (!has_required(node, value)) {
+        return "required";
+      }
+    }
+
+    if (!node.any_of.empty() &&
+        std::none_of(node.any_of.begin(), node.any_of.end(),
+                     [&](uint32_t i) { return valid(i, value); })) {
+      return "anyOf";
+    } else if (!node.one_of.empty() &&
+               std::count_if(node.one_of.begin(), node.one_of.end(),
+                             [&](uint32_t i) { return valid(i, value); }) !=
+                   1) {
+      return "oneOf";
+    } else if (node.not_ && valid(*node.not_, value)) {
+      return "not";
+    }
+
+    return nullptr;
+  }
+
+  // The nodes applying to element `i` of an array, or to member `key` of an
+  // object, under `nodes`. A single contributing subschema is returned
+  // without copying its list; several are merged into `merged`.
+  std::span<const uint32_t> array_child(std::span<const uint32_t> nodes,
+                                        size_t i,
+                                        std::vector<uint32_t>& merged) const {
+    return child(nodes, merged, [i](const Node& node) {
+      return i < node.prefix_items.size() ? node.prefix_items[i] : node.items;
+    });
+  }
+
+  std::span<const uint32_t> object_child(std::span<const uint32_t> nodes,
+                                         std::string_view key,
+                                         std::vector<uint32_t>& merged) const {
+    return child(nodes, merged, [key](const Node& node) {
+      auto it = std::lower_bound(
+          node.properties.begin(), node.properties.end(), key,
+          [](const auto& property, std::string_view k) {
+            return property.first < k;
+          });
+      if (it != node.properties.end() && it->first == key) {
+        return std::optional<uint32_t>(it->second);
+      }
+
+      return node.additional_properties;
+    });
+  }
+
+  // Checks `value` and its subtree against `nodes`. On failure, and if
+  // `error` is set, stores the pointer of the failing value and the keyword.
+  bool run(const Value& value, std::span<const uint32_t> nodes,
+           std::string* error) const {
+    struct Frame {
+      const Value* value;
+      std::span<const uint32_t> nodes;
+      std::vector<uint32_t> merged;
+      Value::const_iterator it;
+      size_t index;
+    };
+
+    auto fail = [&](const std::vector<Frame>& stack, const char* keyword) {
+      if (error != nullptr) {
+        *error = pointer(stack) + ": fails \"" + keyword + "\"";
+      }
+
+      return false;
+    };
+
+    std::vector<Frame> stack;
+    auto visit = [&](const Value& v, std::span<const uint32_t> applied,
+                     std::vector<uint32_t> merged) {
+      stack.push_back({&v, applied, std::move(merged), {}, 0});
+      for (uint32_t i : applied) {
+        if (const char* keyword = check(nodes_[i], v)) {
+          return keyword;
+        }
+      }
+
+      if (v.is_array() || v.is_object()) {
+        stack.back().it = v.begin();
+      } else {
+        stack.pop_back();
+      }
+
+      return static_cast<const char*>(nullptr);
+    };
+
+    if (const char* keyword = visit(value, nodes, {})) {
+      return fail(stack, keyword);
+    }
+
+    while (!stack.empty()) {
+      Frame& top = stack.back();
+      if (top.it == top.value->end()) {
+        stack.pop_back();
+        continue;
+      }
+
+      auto it = top.it++;
+      size_t i = top.index++;
+      std::vector<uint32_t> merged;
+      std::span<const uint32_t> applied =
+          top.value->is_array() ? array_child(top.nodes, i, merged)
+                                : object_child(top.nodes, it.key(), merged);
+      if (applied.empty()) {
+        continue;
+      }
+
+      if (const char* keyword = visit(*it, applied, std::move(merged))) {
+        return fail(stack, keyword);
+      }
+    }
+
+    return true;
+  }
+
+  bool valid(uint32_t node, const Value& value) const {
+    return run(value, nodes_[node].applied, nullptr);
+  }
+
+ private:
+  template <typename Select>
+  std::span<const uint32_t> child(std::span<const uint32_t> nodes,
+                                  std::vector<uint32_t>& merged,
+                                  Select select) const {
+    std::span<const uint32_t> single;
+    for (uint32_t i : nodes) {
+      std::optional<uint32_t> target = select(nodes_[i]);
+      if (!target || nodes_[*target].applied.empty()) {
+        continue;
+      }
+
+      const std::vector<uint32_t>& applied = nodes_[*target].applied;
+      if (single.empty() && merged.empty()) {
+        single = applied;
+        continue;
+      }
+
+      if (merged.empty()) {
+        merged.assign(single.begin(), single.end());
+      }
+
+      for (uint32_t n : applied) {
+        if (std::find(merged.begin(), merged.end(), n) == merged.end()) {
+          merged.push_back(n);
+        }
+      }
+    }
+
+    return merged.empty() ? single : std::span<const uint32_t>(merged);
+  }
+
+  // Both lists are sorted, so one pass over the members suffices.
+  static bool has_required(const Node& node, const Value& object) {
+    auto member = object.begin();
+    for (const std::string& key : node.required) {
+      while (member != object.end() && member.key() < key) {
+        ++member;
+      }
+
+      if (member == object.end() || member.key() != key) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Pointer of the innermost frame's value; each frame's iterator sits one
+  // past the child it descended into.
+  template <typename Frames>
+  static std::string pointer(const Frames& stack) {
+    std::string res;
+    for (size_t i = 0; i + 1 < stack.size(); i++) {
+      if (stack[i].value->is_array()) {
+        res += '/' + std::to_string(stack[i].index - 1);
+      } else {
+        auto it = stack[i].it;
+        append_pointer_token(res, (--it).key());
+      }
+    }
+
+    return res;
+  }
+
+  const std::vector<Node>& nodes_;
+};
+
+// Validates parse events as they arrive while building the tree. Scalars
+// are checked as soon as they are lexed and containers' types as soon as
+// they open; keywords that need a whole container run when it closes.
+class Schema::StreamValidator final : public TreeBuilder {
+ public:
+  StreamValidator(const std::vector<Node>& nodes, uint32_t root)
+      : nodes_(nodes), validator_(nodes), root_(nodes[root].applied) {}
+
+  void scalar(Value value) override {
+    std::vector<uint32_t> merged;
+    std::span<const uint32_t> applied = next(merged);
+    for (uint32_t i : applied) {
+      if (const char* keyword = validator_.check(nodes_[i], value)) {
+        fail(keyword, true);
+      }
+    }
+
+    TreeBuilder::scalar(std::move(value));
+  }
+
+  void begin_array() override { open(kArray); }
+
+  void end_array() override { close(); }
+
+  void begin_object() override { open(kObject); }
+
+  void key(std::string key) override {
+    stack_.back().key = key;
+    TreeBuilder::key(std::move(key));
+  }
+
+  void end_object() override { close(); }
+
+ private:
+  struct Frame {
+    std::span<const uint32_t> nodes;
+    std::vector<uint32_t> merged;
+    bool is_array;
+    size_t index;
+    std::string key;
+  };
+
+  // The nodes applying to the value about to start.
+  std::span<const uint32_t> next(std::vector<uint32_t>& merged) {
+    if (stack_.empty()) {
+      return root_;
+    }
+
+    Frame& top = stack_.back();
+    return top.is_array ? validator_.array_child(top.nodes, top.index++, merged)
+                        : validator_.object_child(top.nodes, top.key, merged);
+  }
+
+  void open(uint8_t type) {
+    std::vector<uint32_t> merged;
+    std::span<const uint32_t> applied = next(merged);
+    for (uint32_t i : applied) {
+      const Node& node = nodes_[i];
+      if (node.never || (node.types & type) == 0) {
+        fail(node.never ? "false" : "type", true);
+      }
+    }
+
+    stack_.push_back(
+        {applied, std::move(merged), type == kArray, 0, std::string()});
+    if (type == kArray) {
+      TreeBuilder::begin_array();
+    } else {
+      TreeBuilder::begin_object();
+    }
+  }
+
+  void close() {
+    const Value& value = innermost();
+    for (uint32_t i : stack_.back().nodes) {
+      if (const char* keyword = validator_.check(nodes_[i], value)) {
+        fail(keyword, false);
+      }
+    }
+
+    bool is_array = stack_.back().is_array;
+    stack_.pop_back();
+    if (is_array) {
+      TreeBuilder::end_array();
+    } else {
+      TreeBuilder::end_object();
+    }
+  }
+
+  // `pending` is set when the failing value has not been pushed yet, so the
+  // innermost frame still points at it.
+  [[noreturn]] void fail(const char* keyword, bool pending) const {
+    std::string pointer;
+    size_t depth = stack_.size() - (pending ? 0 : 1);
+    for (size_t i = 0; i < depth; i++) {
+      const Frame& frame = stack_[i];
+      if (frame.is_array) {
+        pointer += '/' + std::to_string(frame.index - 1);
+      } else {
+        append_pointer_token(pointer, frame.key);
+      }
+    }
+
+    throw ValidationException(pointer + ": fails \"" + keyword + "\"");
+  }
+
+  const std::vector<Node>& nodes_;
+  Validator validator_;
+  std::span<const uint32_t> root_;
+  std::vector<Frame> stack_;
+};
+
+Schema::Schema(const Value& schema) { Compiler(schema, nodes_).run(); }
+
+Schema::~Schema() = default;
+
+Schema::Schema(Schema&&) noexcept = default;
+
+Schema& Schema::operator=(Schema&&) noexcept = default;
+
+// Raw values have no type until parsed and compare unequal to their trees,
+// so an instance holding any is validated as an expanded copy.
+bool Schema::valid(const Value& value) const {
+  if (contains_raw(value)) {
+    Value expanded = value;
+    expand(expanded);
+    return valid(expanded);
+  }
+
+  return Validator(nodes_).valid(0, value);
+}
+
+void Schema::validate(const Value& value) const {
+  if (contains_raw(value)) {
+    Value expanded = value;
+    expand(expanded);
+    return validate(expanded);
+  }
+
+  std::string error;
+  if (!Validator(nodes_).run(value, nodes_[0].applied, &error)) {
+    throw ValidationException(error);
+  }
+}
+
+Value Schema::parse(std::string json) const {
+  StreamValidator validator(nodes_, 0);
+  Parser(Lexer(std::move(json))).parse(validator);
+  return validator.release();
+}
+
+}  // namespace json
+}  // namespace warren
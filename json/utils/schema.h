@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+// A JSON Schema (draft 2020-12) compiled into a flat validator program.
+//
+// Supported keywords: type, enum, const; minimum, maximum,
+// exclusiveMinimum, exclusiveMaximum, multipleOf; minLength, maxLength,
+// pattern; prefixItems, items, minItems, maxItems, uniqueItems; properties,
+// required, additionalProperties, minProperties, maxProperties; allOf,
+// anyOf, oneOf, not; $defs, and $ref to "#" or a JSON pointer fragment within
+// the schema. Annotations are ignored. Other assertion keywords throw
+// SchemaException when compiling rather than being silently skipped.
+//
+// Compiling resolves every $ref and allOf up front into the list of
+// subschemas that apply to an instance, sorts property names and required
+// keys for merge joins against object members, and skips subtrees that no
+// subschema constrains. Validation stops at the first violation. An instance
+// holding Raw values is validated as a copy with them parsed.
+class Schema {
+ public:
+  // Throws SchemaException if `schema` is malformed or uses an unsupported
+  // keyword.
+  explicit Schema(const Value& schema);
+  ~Schema();
+
+  Schema(Schema&&) noexcept;
+  Schema& operator=(Schema&&) noexcept;
+
+  Schema(const Schema&) = delete;
+  Schema& operator=(const Schema&) = delete;
+
+  bool valid(const Value& value) const;
+
+  // Throws ValidationException naming the JSON pointer of the first
+  // violation.
+  void validate(const Value& value) const;
+
+  // Parses `json` and validates it as it is read: a violation throws
+  // ValidationException as soon as the offending value has been lexed, before
+  // the rest of the input is parsed. Malformed JSON throws ParseException.
+  Value parse(std::string json) const;
+
+ private:
+  struct Node;
+  class Compiler;
+  class Validator;
+  class StreamValidator;
+
+  std::vector<Node> nodes_;
+};
+
+}  // namespace json
+}  // namespace warren
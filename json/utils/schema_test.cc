@@ -0,0 +1,211 @@
+#include "warren/json/utils/schema.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::Eq;
+using ::testing::HasSubstr;
+using ::testing::Throws;
+using ::testing::ThrowsMessage;
+
+auto error(const std::string& message) {
+  return ThrowsMessage<ValidationException>(HasSubstr(message));
+}
+
+const Schema kPerson(R"({
+  "type": "object",
+  "properties": {
+    "name": {"type": "string", "minLength": 1, "maxLength": 3},
+    "age": {"type": "integer", "minimum": 0, "exclusiveMaximum": 150},
+    "email": {"type": "string", "pattern": "^[^@]+@[^@]+$"},
+    "tags": {
+      "type": "array",
+      "items": {"enum": ["a", "b", "c"]},
+      "maxItems": 2,
+      "uniqueItems": true
+    },
+    "point": {"prefixItems": [{"type": "number"}, {"type": "number"}],
+              "items": false}
+  },
+  "required": ["name", "age"],
+  "additionalProperties": false
+})"_json);
+
+TEST(SchemaTest, Valid) {
+  EXPECT_TRUE(kPerson.valid(R"({"name": "Ada", "age": 36})"_json));
+  EXPECT_TRUE(kPerson.valid(R"({"name": "Ada", "age": 36.0})"_json));
+  EXPECT_TRUE(kPerson.valid(
+      R"({"name": "Åsa", "age": 1, "email": "a@b", "tags": ["a", "c"],
+          "point": [1, 2.5]})"_json));
+}
+
+TEST(SchemaTest, Invalid) {
+  EXPECT_FALSE(kPerson.valid("[]"_json));
+  EXPECT_FALSE(kPerson.valid(R"({"name": "Ada"})"_json));
+  EXPECT_FALSE(kPerson.valid(R"({"name": "", "age": 1})"_json));
+  EXPECT_FALSE(kPerson.valid(R"({"name": "Adam", "age": 1})"_json));
+  EXPECT_FALSE(kPerson.valid(R"({"name": "Ada", "age": 1.5})"_json));
+  EXPECT_FALSE(kPerson.valid(R"({"name": "Ada", "age": 150})"_json));
+  EXPECT_FALSE(kPerson.valid(R"({"name": "Ada", "age": 1, "x": 1})"_json));
+  EXPECT_FALSE(
+      kPerson.valid(R"({"name": "Ada", "age": 1, "email": "a@b@c"})"_json));
+  EXPECT_FALSE(
+      kPerson.valid(R"({"name": "Ada", "age": 1, "tags": ["d"]})"_json));
+  EXPECT_FALSE(
+      kPerson.valid(R"({"name": "Ada", "age": 1, "tags": ["a", "a"]})"_json));
+  EXPECT_FALSE(kPerson.valid(
+      R"({"name": "Ada", "age": 1, "tags": ["a", "b", "c"]})"_json));
+  EXPECT_FALSE(
+      kPerson.valid(R"({"name": "Ada", "age": 1, "point": [1, 2, 3]})"_json));
+}
+
+TEST(SchemaTest, ValidateReportsPointer) {
+  EXPECT_THAT([] { kPerson.validate(R"({"name": "Ada"})"_json); },
+              error(": fails \"required\""));
+  EXPECT_THAT(
+      [] { kPerson.validate(R"({"name": "A", "age": 1, "tags": [1]})"_json); },
+      error("/tags/0: fails \"enum\""));
+
+  const Schema schema(R"({"properties": {"a/b~": {"type": "null"}}})"_json);
+  EXPECT_THAT([&] { schema.validate(R"({"a/b~": 1})"_json); },
+              error("/a~1b~0: fails \"type\""));
+}
+
+TEST(SchemaTest, Raw) {
+  EXPECT_TRUE(kPerson.valid(Value(Raw{R"({"name": "Ada", "age": 36})"})));
+  EXPECT_TRUE(kPerson.valid(object_t{
+      {"name", "Ada"}, {"age", Raw{"36"}}, {"tags", Raw{R"(["a"])"}}}));
+  EXPECT_FALSE(kPerson.valid(object_t{{"name", "Ada"}, {"age", Raw{"1.5"}}}));
+
+  const Value value =
+      object_t{{"name", "A"}, {"age", 1}, {"tags", array_t{Raw{"1"}}}};
+  EXPECT_THAT([&] { kPerson.validate(value); },
+              error("/tags/0: fails \"enum\""));
+
+  const Schema schema(R"({"const": {"a": [1, 2]}})"_json);
+  EXPECT_TRUE(schema.valid(object_t{{"a", Raw{"[1, 2]"}}}));
+  EXPECT_FALSE(schema.valid(object_t{{"a", Raw{"[1, 3]"}}}));
+}
+
+TEST(SchemaTest, Combinators) {
+  const Schema schema(R"({
+    "anyOf": [{"type": "string"}, {"type": "number", "multipleOf": 3}],
+    "not": {"const": "no"},
+    "allOf": [{"maxLength": 2}]
+  })"_json);
+  EXPECT_TRUE(schema.valid(R"("ab")"_json));
+  EXPECT_TRUE(schema.valid("9"_json));
+  EXPECT_FALSE(schema.valid("10"_json));
+  EXPECT_FALSE(schema.valid(R"("no")"_json));
+  EXPECT_FALSE(schema.valid(R"("abc")"_json));
+  EXPECT_FALSE(schema.valid("null"_json));
+
+  const Schema one_of(R"({"oneOf": [{"minimum": 0}, {"maximum": 10}]})"_json);
+  EXPECT_TRUE(one_of.valid("-1"_json));
+  EXPECT_TRUE(one_of.valid("11"_json));
+  EXPECT_FALSE(one_of.valid("5"_json));
+}
+
+TEST(SchemaTest, Refs) {
+  const Schema tree(R"({
+    "$defs": {
+      "node": {
+        "type": "object",
+        "properties": {
+          "value": {"type": "integer"},
+          "children": {"type": "array", "items": {"$ref": "#/$defs/node"}}
+        },
+        "required": ["value"]
+      }
+    },
+    "$ref": "#/$defs/node"
+  })"_json);
+  EXPECT_TRUE(tree.valid(
+      R"({"value": 1, "children": [{"value": 2, "children": []}]})"_json));
+  EXPECT_FALSE(
+      tree.valid(R"({"value": 1, "children": [{"value": "2"}]})"_json));
+  EXPECT_FALSE(tree.valid(R"({"value": 1, "children": [{}]})"_json));
+
+  const Schema list(R"({"type": "array", "items": {"$ref": "#"}})"_json);
+  EXPECT_TRUE(list.valid("[[], [[]]]"_json));
+  EXPECT_FALSE(list.valid("[[], [1]]"_json));
+
+  // Fragments are percent-decoded before being resolved as pointers.
+  const Schema escaped(R"({
+    "$defs": {"a%b": {"type": "integer"}, "c d": {"type": "string"}},
+    "properties": {
+      "x": {"$ref": "#/$defs/a%25b"},
+      "y": {"$ref": "#/$defs/c%20d"}
+    }
+  })"_json);
+  EXPECT_TRUE(escaped.valid(R"({"x": 1, "y": "z"})"_json));
+  EXPECT_FALSE(escaped.valid(R"({"x": "1"})"_json));
+  EXPECT_FALSE(escaped.valid(R"({"y": 1})"_json));
+}
+
+TEST(SchemaTest, HugeCounts) {
+  const Schema schema(R"({"maxLength": 1e30, "minItems": 1e300})"_json);
+  EXPECT_TRUE(schema.valid(R"("abc")"_json));
+  EXPECT_FALSE(schema.valid("[1, 2]"_json));
+}
+
+TEST(SchemaTest, PatternOnLongString) {
+  // A backtracking matcher recurses once per repetition here.
+  const Schema schema(R"({"pattern": "^(a|b)*$"})"_json);
+  std::string s(200000, 'a');
+  EXPECT_TRUE(schema.valid(Value(s)));
+  s.back() = 'c';
+  EXPECT_FALSE(schema.valid(Value(s)));
+}
+
+TEST(SchemaTest, BooleanSchemas) {
+  EXPECT_TRUE(Schema(Value(true)).valid("[1]"_json));
+  EXPECT_FALSE(Schema(Value(false)).valid("null"_json));
+  EXPECT_TRUE(Schema("{}"_json).valid(R"({"a": [1]})"_json));
+}
+
+TEST(SchemaTest, Parse) {
+  EXPECT_THAT(kPerson.parse(R"({"name": "Ada", "age": 36})"),
+              Eq(R"({"name": "Ada", "age": 36})"_json));
+
+  // The violation is reported before the malformed tail is reached.
+  EXPECT_THAT([] { kPerson.parse(R"({"name": 7, "age": 36, ]]]]})"); },
+              error("/name: fails \"type\""));
+  EXPECT_THAT([] { kPerson.parse(R"({"tags": {]]]})"); },
+              error("/tags: fails \"type\""));
+  EXPECT_THAT([] { kPerson.parse(R"([)"); }, error(": fails \"type\""));
+  EXPECT_THAT([] { kPerson.parse(R"({"name": "Ada"})"); },
+              error(": fails \"required\""));
+  EXPECT_THAT(
+      [] { kPerson.parse(R"({"name": "Ada", "age": 1, "tags": ["b", "b"]})"); },
+      error("/tags: fails \"uniqueItems\""));
+  EXPECT_THAT([] { kPerson.parse(R"({"name": "Ada", "age": 1)"); },
+              Throws<ParseException>());
+}
+
+TEST(SchemaTest, Malformed) {
+  EXPECT_THROW(Schema("1"_json), SchemaException);
+  EXPECT_THROW(Schema(R"({"type": "float"})"_json), SchemaException);
+  EXPECT_THROW(Schema(R"({"minLength": -1})"_json), SchemaException);
+  EXPECT_THROW(Schema(R"({"pattern": "("})"_json), SchemaException);
+  EXPECT_THROW(Schema(R"({"pattern": "a(?=b)c"})"_json), SchemaException);
+  EXPECT_THROW(Schema(R"({"anyOf": []})"_json), SchemaException);
+  EXPECT_THROW(Schema(R"({"$ref": "#/missing"})"_json), SchemaException);
+  EXPECT_THROW(Schema(R"({"$ref": "other.json"})"_json), SchemaException);
+  EXPECT_THROW(Schema(R"({"$ref": "#/a%2"})"_json), SchemaException);
+  EXPECT_THROW(Schema(R"({"contains": {}})"_json), SchemaException);
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
@@ -1,82 +1,148 @@
 #include "warren/json/utils/to_string.h"
 
-#include <iomanip>
-#include <sstream>
+#include <algorithm>  // max, min
+#include <cstddef>    // size_t
+#include <exception>
+#include <iterator>  // next
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #include "warren/json/parse/lexer.h"
 #include "warren/json/parse/token.h"
+#include "warren/json/utils/writer.h"
 #include "warren/json/value.h"
 
 namespace {
 
-struct Printer {
-  size_t level = 0;
-  const warren::json::PrintOptions& opts;
-
-  std::string indent() const {
-    return opts.compact ? "" : std::string(level * opts.tab_width, ' ');
-  }
-
-  std::string format(double d) const {
-    std::ostringstream oss;
-    oss << std::setprecision(15) << std::defaultfloat << d;
-
-    return oss.str();
-  }
-
-  std::string print(const warren::json::Value& value) {
-    return value.visit(
-        []() -> std::string { return "null"; },
-        [](bool b) -> std::string { return (b ? "true" : "false"); },
-        [](int32_t i) -> std::string { return std::to_string(i); },
-        [this](double d) -> std::string { return format(d); },
-        [](const std::string& s) -> std::string { return "\"" + s + "\""; },
-        [this](const warren::json::array_t& a) -> std::string {
-          if (a.empty()) {
-            return "[]";
-          }
-
-          std::string array;
-          array += "[";
-          array += (opts.compact ? "" : "\n");
-          level++;
-          for (size_t i = 0; i < a.size(); i++) {
-            array += indent() + print(a[i]) +
-                     (i < a.size() - 1 || opts.trailing_commas ? "," : "") +
-                     (opts.compact ? "" : "\n");
-          }
-
-          level--;
-          array += indent() + "]";
-
-          return array;
-        },
-        [this](const warren::json::object_t& o) -> std::string {
-          if (o.empty()) {
-            return "{}";
-          }
-
-          std::string object;
-          object += "{";
-          object += (opts.compact ? "" : "\n");
-          level++;
-          size_t i = 0;
-          for (const auto& [k, v] : o) {
-            object += indent() + "\"" + k + "\":" + (opts.compact ? "" : " ") +
-                      print(v) +
-                      (i++ < o.size() - 1 || opts.trailing_commas ? "," : "") +
-                      (opts.compact ? "" : "\n");
-          }
-
-          level--;
-          object += indent() + "}";
-
-          return object;
-        });
+// Fewer children than this per thread are not worth a thread.
+constexpr size_t kMinChildrenPerThread = 256;
+
+size_t thread_count(size_t threads, size_t children) {
+  if (threads == 0) {
+    threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
   }
+
+  return std::min(threads, children / kMinChildrenPerThread);
+}
+
+// Buffers rendered by the workers, and the pieces of them (plus separators)
+// that concatenate to the full output.
+struct Rendered {
+  std::vector<std::string> buffers;
+  std::vector<std::string_view> pieces;
 };
 
+// Renders [begin, end) as a complete container with its own Writer.
+template <typename It, typename Emit>
+std::string render(It begin, It end, bool object,
+                   const warren::json::PrintOptions& opts, Emit emit) {
+  std::string out;
+  warren::json::Writer writer(out, opts);
+  object ? writer.begin_object() : writer.begin_array();
+  for (It it = begin; it != end; ++it) {
+    emit(writer, it);
+  }
+
+  object ? writer.end_object() : writer.end_array();
+  return out;
+}
+
+// Splits the children of `container` into `threads` runs and renders each on
+// its own thread.
+template <typename Container, typename Emit>
+Rendered render_parallel(const Container& container, bool object,
+                         const warren::json::PrintOptions& opts,
+                         size_t threads, Emit emit) {
+  std::vector<typename Container::const_iterator> bounds = {container.begin()};
+  size_t chunk = container.size() / threads;
+  for (size_t i = 1; i < threads; i++) {
+    bounds.push_back(std::next(bounds.back(), static_cast<long>(chunk)));
+  }
+
+  bounds.push_back(container.end());
+
+  Rendered res;
+  res.buffers.resize(threads);
+  std::vector<std::exception_ptr> errors(threads);
+  {
+    std::vector<std::jthread> workers;
+    for (size_t i = 0; i < threads; i++) {
+      workers.emplace_back([&, i]() {
+        try {
+          res.buffers[i] = render(bounds[i], bounds[i + 1], object, opts, emit);
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+      });
+    }
+  }
+
+  for (const std::exception_ptr& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  // Each buffer is a complete container; only its opening bracket and its
+  // closing "\n]" (or "]", and a trailing comma) are dropped, leaving the
+  // indented children and the separators between them.
+  size_t close = opts.compact ? 1 : 2;
+  if (opts.trailing_commas) {
+    close++;
+  }
+
+  const std::string_view open = object ? "{" : "[";
+  res.pieces.push_back(open);
+  for (size_t i = 0; i < threads; i++) {
+    if (i > 0) {
+      res.pieces.push_back(",");
+    }
+
+    std::string_view buffer = res.buffers[i];
+    res.pieces.push_back(buffer.substr(1, buffer.size() - 1 - close));
+  }
+
+  // The last buffer's closing sequence is the document's.
+  std::string_view last = res.buffers.back();
+  res.pieces.push_back(last.substr(last.size() - close));
+  return res;
+}
+
+// Pieces that concatenate to to_string(value, opts), or none if the value is
+// too small to be worth splitting or canonical. Canonical output reorders
+// members across the whole object and overrides the layout options the
+// slicing above relies on, so it is left to the serial path.
+Rendered render_parallel(const warren::json::Value& value,
+                         const warren::json::PrintOptions& opts,
+                         size_t threads) {
+  using warren::json::Value;
+  using warren::json::Writer;
+  if (opts.canonical) {
+    return {};
+  }
+
+  if (const auto* a = value.get_if<warren::json::array_t>()) {
+    threads = thread_count(threads, a->size());
+    if (threads > 1) {
+      return render_parallel(
+          *a, false, opts, threads,
+          [](Writer& writer, auto it) { writer.value(*it); });
+    }
+  } else if (const auto* o = value.get_if<warren::json::object_t>()) {
+    threads = thread_count(threads, o->size());
+    if (threads > 1) {
+      return render_parallel(
+          *o, true, opts, threads, [](Writer& writer, auto it) {
+            writer.key(it->first).value(it->second);
+          });
+    }
+  }
+
+  return {};
+}
+
 }  // namespace
 
 namespace warren {
@@ -133,7 +199,55 @@ std::string to_string(const Lexer::Error& error) {
 }
 
 std::string to_string(const Value& value, const PrintOptions& opts) {
-  return Printer{.opts = opts}.print(value);
+  std::string out;
+  print(value, out, opts);
+  return out;
+}
+
+void print(const Value& value, std::string& out, const PrintOptions& opts) {
+  Writer(out, opts).value(value);
+}
+
+void print(const Value& value, Sink& sink, const PrintOptions& opts) {
+  Writer(sink, opts).value(value);
+}
+
+std::string to_string_parallel(const Value& value, const PrintOptions& opts,
+                               size_t threads) {
+  Rendered rendered = render_parallel(value, opts, threads);
+  if (rendered.pieces.empty()) {
+    return to_string(value, opts);
+  }
+
+  size_t size = 0;
+  for (std::string_view piece : rendered.pieces) {
+    size += piece.size();
+  }
+
+  std::string out;
+  out.reserve(size);
+  for (std::string_view piece : rendered.pieces) {
+    out += piece;
+  }
+
+  return out;
+}
+
+void print_parallel(const Value& value, Sink& sink, const PrintOptions& opts,
+                    size_t threads) {
+  Rendered rendered = render_parallel(value, opts, threads);
+  if (rendered.pieces.empty()) {
+    print(value, sink, opts);
+    return;
+  }
+
+  // The buffers live until the sink is flushed, so the pieces need not be
+  // copied.
+  for (std::string_view piece : rendered.pieces) {
+    sink.write_ref(piece);
+  }
+
+  sink.flush();
 }
 
 }  // namespace json
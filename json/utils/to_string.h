@@ -1,20 +1,16 @@
 #pragma once
 
+#include <ostream>
 #include <string>
 
 #include "warren/json/parse/lexer.h"
 #include "warren/json/parse/token.h"
+#include "warren/json/utils/writer.h"
 #include "warren/json/value.h"
 
 namespace warren {
 namespace json {
 
-struct PrintOptions {
-  size_t tab_width = 2;
-  bool trailing_commas = false;
-  bool compact = false;
-};
-
 std::string to_string(TokenType type);
 
 std::string to_string(const Token& token);
@@ -23,8 +19,26 @@ std::string to_string(const Lexer::Error& error);
 
 std::string to_string(const Value& value, const PrintOptions& opts = {});
 
+// Appends to `out`. Reusing the same buffer across calls avoids reallocating
+// it for every document.
+void print(const Value& value, std::string& out, const PrintOptions& opts = {});
+
+void print(const Value& value, Sink& sink, const PrintOptions& opts = {});
+
+// Like to_string and print, but a large top-level array or object is split
+// into contiguous runs of children that are rendered on `threads` threads
+// (0 for one per core), each into its own buffer. Output is identical to
+// to_string. Small documents and scalars are printed on the calling thread.
+std::string to_string_parallel(const Value& value,
+                               const PrintOptions& opts = {},
+                               size_t threads = 0);
+
+void print_parallel(const Value& value, Sink& sink,
+                    const PrintOptions& opts = {}, size_t threads = 0);
+
 inline std::ostream& operator<<(std::ostream& os, const Value& v) {
-  os << to_string(v);
+  StreamSink sink(os);
+  print(v, sink);
   return os;
 }
 
@@ -1,6 +1,10 @@
 #include "warren/json/utils/to_string.h"
 
+#include <cstdio>
+#include <limits>
 #include <sstream>
+#include <string>
+#include <string_view>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -12,6 +16,7 @@ namespace json {
 namespace {
 
 using ::testing::Eq;
+using ::testing::Optional;
 
 TEST(UtilsTest, PrettyPrint) {
   EXPECT_THAT(to_string(
@@ -227,6 +232,156 @@ TEST(UtilsTest, PrettyPrintOstream) {
 })"));
 }
 
+TEST(UtilsTest, PrintAppends) {
+  std::string out = "x";
+  print("[1, 2]"_json, out, PrintOptions{.compact = true});
+  print("{}"_json, out);
+  EXPECT_THAT(out, Eq("x[1,2]{}"));
+}
+
+TEST(UtilsTest, PrintNumbersRoundTrip) {
+  EXPECT_THAT(to_string(Value(0.1 + 0.2)), Eq("0.30000000000000004"));
+  EXPECT_THAT(to_string(Value(1e300)), Eq("1e+300"));
+  EXPECT_THAT(to_string(Value(-2.5e-7)), Eq("-2.5e-07"));
+  EXPECT_THAT(to_string(Value(std::numeric_limits<int32_t>::min())),
+              Eq("-2147483648"));
+  EXPECT_THAT(to_string(Value(std::numeric_limits<double>::infinity())),
+              Eq("null"));
+
+  for (double d : {0.1, 1.0 / 3, 123456.789e-12, 6.02214076e23, 1.7e308}) {
+    EXPECT_THAT(parse(to_string(Value(d))).try_get<double>(), Optional(d));
+  }
+}
+
+TEST(UtilsTest, PrintEscapesStrings) {
+  EXPECT_THAT(to_string(Value("say \"hi\"\\\n\t\x01")),
+              Eq(R"("say \"hi\"\\\n\t\u0001")"));
+  EXPECT_THAT(to_string(object_t{{"a\"b", 1}}, PrintOptions{.compact = true}),
+              Eq(R"({"a\"b":1})"));
+  EXPECT_THAT(to_string(Value("caf\xc3\xa9")), Eq("\"caf\xc3\xa9\""));
+
+  // Long clean runs around the escapes exercise the vectorized scan.
+  std::string s = std::string(40, 'x') + "\"" + std::string(17, 'y') + "\\";
+  EXPECT_THAT(to_string(Value(s)),
+              Eq("\"" + std::string(40, 'x') + "\\\"" + std::string(17, 'y') +
+                 "\\\\\""));
+
+  const Value value = parse(R"(["a\"b\\c\n\u00e9", {"k\tv": "\/"}])");
+  EXPECT_THAT(parse(to_string(value)), Eq(value));
+
+  // A backslash is always escaped, even when it reads like a \u escape.
+  const Value path("C:\\u0041dir");
+  EXPECT_THAT(to_string(path), Eq(R"("C:\\u0041dir")"));
+  EXPECT_THAT(parse(to_string(path)), Eq(path));
+  EXPECT_THAT(serialized_size(path), Eq(to_string(path).size()));
+}
+
+TEST(UtilsTest, PrintAscii) {
+  const PrintOptions opts{.ascii = true};
+  EXPECT_THAT(to_string(Value("caf\xc3\xa9 \xe2\x82\xac"), opts),
+              Eq(R"("caf\u00e9 \u20ac")"));
+  EXPECT_THAT(to_string(Value("\xf0\x9f\x98\x80"), opts),
+              Eq(R"("\ud83d\ude00")"));
+  EXPECT_THAT(to_string(Value("\xff\xc3"), opts), Eq(R"("\ufffd\ufffd")"));
+  EXPECT_THAT(to_string(Value("\xc0\xaf"), opts), Eq(R"("\ufffd\ufffd")"));
+}
+
+class ChunkSink : public Sink {
+ public:
+  void write(std::string_view data) override {
+    chunks++;
+    out += data;
+  }
+
+  size_t chunks = 0;
+  std::string out;
+};
+
+TEST(UtilsTest, PrintSinkMatchesToString) {
+  Value value = array_t();
+  for (int32_t i = 0; i < 20000; i++) {
+    value.push_back(object_t{{"id", i}, {"tags", array_t{"a", "b"}}});
+  }
+
+  for (const PrintOptions& opts :
+       {PrintOptions{}, PrintOptions{.trailing_commas = true},
+        PrintOptions{.compact = true}}) {
+    ChunkSink sink;
+    print(value, sink, opts);
+    EXPECT_THAT(sink.out, Eq(to_string(value, opts)));
+    EXPECT_THAT(sink.chunks > 1, Eq(true));
+  }
+}
+
+TEST(UtilsTest, ParallelMatchesToString) {
+  Value array = array_t();
+  Value object = object_t();
+  for (int32_t i = 0; i < 5000; i++) {
+    array.push_back(object_t{{"id", i}, {"tags", array_t{"a", "b"}}});
+    object[std::to_string(i)] = array_t{i, "x\n"};
+  }
+
+  for (const PrintOptions& opts :
+       {PrintOptions{}, PrintOptions{.trailing_commas = true},
+        PrintOptions{.compact = true},
+        PrintOptions{.trailing_commas = true, .compact = true}}) {
+    for (const Value& value : {array, object}) {
+      EXPECT_THAT(to_string_parallel(value, opts, 4),
+                  Eq(to_string(value, opts)));
+
+      ChunkSink sink;
+      print_parallel(value, sink, opts, 3);
+      EXPECT_THAT(sink.out, Eq(to_string(value, opts)));
+    }
+  }
+
+  // Canonical output sorts members ("10" before "9") and ignores the layout
+  // options.
+  const PrintOptions canonical{.tab_width = 4,
+                               .trailing_commas = true,
+                               .canonical = true};
+  for (const Value& value : {array, object}) {
+    EXPECT_THAT(to_string_parallel(value, canonical, 4),
+                Eq(to_string(value, canonical)));
+  }
+
+  EXPECT_THAT(to_string_parallel("[1, 2]"_json), Eq(to_string("[1, 2]"_json)));
+  EXPECT_THAT(to_string_parallel("3"_json), Eq("3"));
+}
+
+TEST(UtilsTest, PrintParallelWritevSink) {
+  Value array = array_t();
+  for (int32_t i = 0; i < 5000; i++) {
+    array.push_back(object_t{{"id", i}, {"name", "x"}});
+  }
+
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+  WritevSink sink(fileno(file));
+  print_parallel(array, sink, PrintOptions{}, 4);
+  std::rewind(file);
+  std::string out;
+  char buf[4096];
+  while (size_t n = std::fread(buf, 1, sizeof(buf), file)) {
+    out.append(buf, n);
+  }
+
+  std::fclose(file);
+  EXPECT_THAT(out == to_string(array), Eq(true));
+}
+
+TEST(UtilsTest, PrintFdSink) {
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+  FdSink sink(fileno(file));
+  print(R"({"a": [1, "b"]})"_json, sink, PrintOptions{.compact = true});
+  std::rewind(file);
+  char buf[64] = {};
+  size_t n = std::fread(buf, 1, sizeof(buf), file);
+  std::fclose(file);
+  EXPECT_THAT(std::string(buf, n), Eq(R"({"a":[1,"b"]})"));
+}
+
 }  // namespace
 
 }  // namespace json
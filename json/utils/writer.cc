@@ -0,0 +1,877 @@
+#include "warren/json/utils/writer.h"
+
+#include <limits.h>   // IOV_MAX
+#include <sys/uio.h>  // iovec, writev
+#include <unistd.h>   // write
+
+#include <algorithm>  // sort
+#include <cerrno>
+#include <charconv>  // from_chars, to_chars
+#include <cmath>     // isfinite
+#include <cstdint>   // uint8_t, uint16_t, uint64_t
+#include <cstring>   // memcpy
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "warren/json/utils/exception.h"
+#include "warren/json/value.h"
+
+namespace {
+
+// Raw text is written as is, so it can't be reformatted into canonical form.
+constexpr const char* kRawCanonical =
+    "raw value must be expanded for canonical JSON";
+
+// RFC 8785 has no encoding for NaN or the infinities.
+constexpr const char* kNonFiniteCanonical =
+    "non-finite number in canonical JSON";
+
+// Flush threshold when writing to a Sink.
+constexpr size_t kChunkSize = 64 * 1024;
+
+// Clean strings at least this long are passed to Sink::write_ref.
+constexpr size_t kMinReference = 4 * 1024;
+
+// WritevSink copies small writes into a buffer of this size; a write that
+// doesn't fit in what is left is written out in place instead.
+constexpr size_t kGatherSize = 16 * 1024;
+
+// Never hand writev more than IOV_MAX buffers at a time.
+constexpr size_t kMaxIovecs = IOV_MAX;
+
+// Sixteen bytes per register: SSE2 or NEON on the usual targets and scalar
+// code elsewhere.
+using byte16 = uint8_t __attribute__((vector_size(16)));
+
+constexpr size_t kBytes = sizeof(byte16);
+
+// Index of the first byte at or after `i` that can't be copied verbatim into
+// a JSON string, or s.size(). Clean runs are skipped a register at a time.
+size_t find_escape(std::string_view s, size_t i, bool ascii) {
+  const uint8_t high = ascii ? 0x7f : 0xff;
+  for (; i + kBytes <= s.size(); i += kBytes) {
+    byte16 v;
+    std::memcpy(&v, s.data() + i, sizeof(v));
+    auto mask = (v < 0x20) | (v == '"') | (v == '\\') | (v > high);
+    uint64_t words[2];
+    std::memcpy(words, &mask, sizeof(words));
+    if (words[0] | words[1]) {
+      break;
+    }
+  }
+
+  for (; i < s.size(); i++) {
+    uint8_t c = static_cast<uint8_t>(s[i]);
+    if (c < 0x20 || c == '"' || c == '\\' || (ascii && c >= 0x80)) {
+      break;
+    }
+  }
+
+  return i;
+}
+
+// Decodes the UTF-8 sequence at s[i], advancing `i` past it. Invalid
+// sequences decode to U+FFFD and consume one byte.
+char32_t decode_utf8(std::string_view s, size_t& i) {
+  uint8_t c = static_cast<uint8_t>(s[i]);
+  size_t len = c >= 0xf0 ? 4 : c >= 0xe0 ? 3 : c >= 0xc0 ? 2 : 0;
+  char32_t cp = c & (0x7f >> len);
+  if (len == 0 || c >= 0xf8 || i + len > s.size()) {
+    i++;
+    return 0xfffd;
+  }
+
+  for (size_t k = 1; k < len; k++) {
+    uint8_t cont = static_cast<uint8_t>(s[i + k]);
+    if ((cont & 0xc0) != 0x80) {
+      i++;
+      return 0xfffd;
+    }
+
+    cp = (cp << 6) | (cont & 0x3f);
+  }
+
+  constexpr char32_t kMin[] = {0, 0, 0x80, 0x800, 0x10000};
+  if (cp < kMin[len] || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) {
+    i++;
+    return 0xfffd;
+  }
+
+  i += len;
+  return cp;
+}
+
+// The options a Writer actually follows.
+warren::json::PrintOptions effective(const warren::json::PrintOptions& opts) {
+  if (!opts.canonical) {
+    return opts;
+  }
+
+  return {.tab_width = 0, .compact = true, .canonical = true};
+}
+
+// ECMAScript Number::toString (ECMA-262 7.1.12.1) on the shortest
+// round-trip digits, as RFC 8785 3.2.2.3 requires. Returns the length
+// written to `out`, which must hold 32 bytes.
+size_t format_canonical(double d, char* out) {
+  if (d == 0) {
+    out[0] = '0';
+    return 1;
+  }
+
+  char sci[32];
+  char* end =
+      std::to_chars(sci, sci + sizeof(sci), d, std::chars_format::scientific)
+          .ptr;
+  std::string_view s(sci, static_cast<size_t>(end - sci));
+  char* p = out;
+  if (s.front() == '-') {
+    *p++ = '-';
+    s.remove_prefix(1);
+  }
+
+  // s is "d[.ddd]e[+-]xx".
+  size_t e = s.find('e');
+  char digits[20];
+  int k = 0;
+  for (char c : s.substr(0, e)) {
+    if (c != '.') {
+      digits[k++] = c;
+    }
+  }
+
+  int exp = 0;
+  std::from_chars(s.data() + e + 2, s.data() + s.size(), exp);
+  if (s[e + 1] == '-') {
+    exp = -exp;
+  }
+
+  auto copy = [&p, &digits](int from, int to) {
+    for (int j = from; j < to; j++) {
+      *p++ = digits[j];
+    }
+  };
+
+  int n = exp + 1;
+  if (k <= n && n <= 21) {
+    copy(0, k);
+    for (int j = k; j < n; j++) {
+      *p++ = '0';
+    }
+  } else if (0 < n && n <= 21) {
+    copy(0, n);
+    *p++ = '.';
+    copy(n, k);
+  } else if (-6 < n && n <= 0) {
+    *p++ = '0';
+    *p++ = '.';
+    for (int j = n; j < 0; j++) {
+      *p++ = '0';
+    }
+
+    copy(0, k);
+  } else {
+    copy(0, 1);
+    if (k > 1) {
+      *p++ = '.';
+      copy(1, k);
+    }
+
+    *p++ = 'e';
+    *p++ = n - 1 < 0 ? '-' : '+';
+    p = std::to_chars(p, out + 32, n - 1 < 0 ? 1 - n : n - 1).ptr;
+  }
+
+  return static_cast<size_t>(p - out);
+}
+
+// Whether the map's byte order of `object`'s keys might differ from UTF-16
+// code unit order. UTF-8 byte order is code point order, which UTF-16 only
+// breaks for characters from U+E000 up (lead bytes 0xEE and above) against
+// supplementary ones.
+bool needs_canonical_sort(const warren::json::object_t& object) {
+  for (const auto& [key, _] : object) {
+    for (char c : key) {
+      if (static_cast<uint8_t>(c) >= 0xee) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+std::u16string to_utf16(std::string_view s) {
+  std::u16string res;
+  for (size_t i = 0; i < s.size();) {
+    char32_t cp = static_cast<uint8_t>(s[i]) < 0x80
+                      ? static_cast<uint8_t>(s[i++])
+                      : decode_utf8(s, i);
+    if (cp >= 0x10000) {
+      res += static_cast<char16_t>(0xd800 + ((cp - 0x10000) >> 10));
+      res += static_cast<char16_t>(0xdc00 + ((cp - 0x10000) & 0x3ff));
+    } else {
+      res += static_cast<char16_t>(cp);
+    }
+  }
+
+  return res;
+}
+
+// Members of `object` in RFC 8785 order. Only called when
+// needs_canonical_sort says the map's own order may not be it.
+std::vector<warren::json::object_t::const_iterator> canonical_order(
+    const warren::json::object_t& object) {
+  std::vector<std::pair<std::u16string, warren::json::object_t::const_iterator>>
+      keyed;
+  for (auto it = object.begin(); it != object.end(); ++it) {
+    keyed.emplace_back(to_utf16(it->first), it);
+  }
+
+  std::sort(keyed.begin(), keyed.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.first < rhs.first;
+  });
+  std::vector<warren::json::object_t::const_iterator> res;
+  for (const auto& [_, it] : keyed) {
+    res.push_back(it);
+  }
+
+  return res;
+}
+
+// Mirrors Writer::string without producing any output.
+size_t escaped_size(std::string_view s, bool ascii) {
+  size_t size = 2;
+  size_t i = 0;
+  while (true) {
+    size_t clean = find_escape(s, i, ascii);
+    size += clean - i;
+    i = clean;
+    if (i == s.size()) {
+      return size;
+    }
+
+    uint8_t c = static_cast<uint8_t>(s[i]);
+    if (c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' ||
+        c == '\r' || c == '\t') {
+      size += 2;
+      i++;
+    } else if (c < 0x20) {
+      size += 6;
+      i++;
+    } else {
+      size += decode_utf8(s, i) >= 0x10000 ? 12u : 6u;
+    }
+  }
+}
+
+// Size of `raw` once its non-ASCII characters are escaped.
+size_t ascii_size(std::string_view raw) {
+  size_t size = 0;
+  for (size_t i = 0; i < raw.size();) {
+    if (static_cast<uint8_t>(raw[i]) < 0x80) {
+      size++;
+      i++;
+    } else {
+      size += decode_utf8(raw, i) >= 0x10000 ? 12u : 6u;
+    }
+  }
+
+  return size;
+}
+
+template <typename T>
+size_t number_size(T n) {
+  char buf[32];
+  return static_cast<size_t>(std::to_chars(buf, buf + sizeof(buf), n).ptr -
+                             buf);
+}
+
+struct Sizer {
+  const warren::json::PrintOptions opts;
+
+  // Newline plus indentation, or nothing when compact.
+  size_t indent(size_t depth) const {
+    return opts.compact ? 0 : 1 + depth * opts.tab_width;
+  }
+
+  // Brackets, separators and indentation around `n` children at `depth`.
+  size_t container(size_t n, size_t depth) const {
+    if (n == 0) {
+      return 2;
+    }
+
+    return 2 + (n - 1) + (opts.trailing_commas ? 1 : 0) +
+           n * indent(depth + 1) + indent(depth);
+  }
+
+  size_t size(const warren::json::Value& root) const {
+    // Containers still being sized, innermost last, so that deeply nested
+    // values don't recurse. A container's depth is its index.
+    struct Level {
+      warren::json::Value::const_iterator it;
+      warren::json::Value::const_iterator end;
+      bool object;
+    };
+
+    std::vector<Level> levels;
+    size_t total = 0;
+    const warren::json::Value* curr = &root;
+    while (curr) {
+      const size_t depth = levels.size();
+      if (curr->is_raw()) {
+        if (opts.canonical) {
+          throw warren::json::WriterException(kRawCanonical);
+        }
+
+        total += opts.ascii ? ascii_size(curr->raw()) : curr->raw().size();
+      } else {
+        total += curr->visit(
+            []() -> size_t { return 4; },
+            [](bool b) -> size_t { return b ? 4 : 5; },
+            [](int32_t i) -> size_t { return number_size(i); },
+            [this](double d) -> size_t {
+              if (!std::isfinite(d)) {
+                if (opts.canonical) {
+                  throw warren::json::WriterException(kNonFiniteCanonical);
+                }
+
+                return 4;
+              }
+
+              char buf[32];
+              return opts.canonical ? format_canonical(d, buf)
+                                    : number_size(d);
+            },
+            [this](const std::string& s) -> size_t {
+              return escaped_size(s, opts.ascii);
+            },
+            [&](const warren::json::array_t& a) -> size_t {
+              levels.push_back({curr->begin(), curr->end(), false});
+              return container(a.size(), depth);
+            },
+            [&](const warren::json::object_t& o) -> size_t {
+              levels.push_back({curr->begin(), curr->end(), true});
+              return container(o.size(), depth);
+            });
+      }
+
+      // Moves on to the next child, dropping the containers it finishes.
+      curr = nullptr;
+      while (!curr && !levels.empty()) {
+        Level& top = levels.back();
+        if (top.it == top.end) {
+          levels.pop_back();
+          continue;
+        }
+
+        if (top.object) {
+          total += escaped_size(top.it.key(), opts.ascii) +
+                   (opts.compact ? 1 : 2);
+        }
+
+        curr = &*top.it;
+        ++top.it;
+      }
+    }
+
+    return total;
+  }
+};
+
+}  // namespace
+
+namespace warren {
+namespace json {
+
+void StreamSink::write(std::string_view data) {
+  os_.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+void FdSink::write(std::string_view data) {
+  while (!data.empty()) {
+    ssize_t n = ::write(fd_, data.data(), data.size());
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      throw std::system_error(errno, std::generic_category(), "write");
+    }
+
+    data.remove_prefix(static_cast<size_t>(n));
+  }
+}
+
+size_t serialized_size(const Value& value, const PrintOptions& opts) {
+  return Sizer{.opts = effective(opts)}.size(value);
+}
+
+WritevSink::WritevSink(int fd) : fd_(fd) { buffer_.resize(kGatherSize); }
+
+void WritevSink::write(std::string_view data) {
+  if (data.empty()) {
+    return;
+  } else if (data.size() > buffer_.size() - used_) {
+    // Too large to copy: write it out in place with what is pending.
+    push(data);
+    flush();
+    return;
+  }
+
+  char* copy = buffer_.data() + used_;
+  std::memcpy(copy, data.data(), data.size());
+  used_ += data.size();
+  // Consecutive copies are contiguous, so they can share an iovec.
+  std::string_view* last = pending_.empty() ? nullptr : &pending_.back();
+  if (last && last->data() + last->size() == copy) {
+    *last = std::string_view(last->data(), last->size() + data.size());
+  } else {
+    push(std::string_view(copy, data.size()));
+  }
+}
+
+void WritevSink::write_ref(std::string_view data) { push(data); }
+
+void WritevSink::push(std::string_view data) {
+  if (data.empty()) {
+    return;
+  }
+
+  pending_.push_back(data);
+  if (pending_.size() >= kMaxIovecs) {
+    flush();
+  }
+}
+
+void WritevSink::flush() {
+  std::vector<iovec> iovecs;
+  size_t next = 0;
+  while (next < pending_.size() || !iovecs.empty()) {
+    while (iovecs.size() < kMaxIovecs && next < pending_.size()) {
+      std::string_view data = pending_[next++];
+      iovecs.push_back(iovec{.iov_base = const_cast<char*>(data.data()),
+                             .iov_len = data.size()});
+    }
+
+    ssize_t n = ::writev(fd_, iovecs.data(), static_cast<int>(iovecs.size()));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      throw std::system_error(errno, std::generic_category(), "writev");
+    }
+
+    // Drop what was written, keeping the remainder of a partial write.
+    size_t written = static_cast<size_t>(n);
+    auto it = iovecs.begin();
+    for (; it != iovecs.end() && written >= it->iov_len; ++it) {
+      written -= it->iov_len;
+    }
+
+    if (it != iovecs.end()) {
+      it->iov_base = static_cast<char*>(it->iov_base) + written;
+      it->iov_len -= written;
+    }
+
+    iovecs.erase(iovecs.begin(), it);
+  }
+
+  pending_.clear();
+  used_ = 0;
+}
+
+Writer::Writer(std::string& out, const PrintOptions& opts)
+    : out_(out), opts_(effective(opts)) {}
+
+Writer::Writer(Sink& sink, const PrintOptions& opts)
+    : out_(buffer_), sink_(&sink), opts_(effective(opts)) {
+  buffer_.reserve(kChunkSize);
+}
+
+Writer& Writer::begin_object() {
+  begin(true, '{');
+  return *this;
+}
+
+Writer& Writer::end_object() {
+  end(true, '}');
+  return *this;
+}
+
+Writer& Writer::begin_array() {
+  begin(false, '[');
+  return *this;
+}
+
+Writer& Writer::end_array() {
+  end(false, ']');
+  return *this;
+}
+
+Writer& Writer::key(std::string_view key) {
+  if (stack_.empty() || !stack_.back().object || stack_.back().has_key) {
+    throw WriterException("key outside of an object or after another key");
+  }
+
+  Frame& frame = stack_.back();
+  if (frame.size > 0) {
+    out_ += ',';
+  }
+
+  indent();
+  string(key);
+  out_ += (opts_.compact ? ":" : ": ");
+  frame.has_key = true;
+  return *this;
+}
+
+Writer& Writer::value(std::nullptr_t) {
+  before_value();
+  out_ += "null";
+  after_value();
+  return *this;
+}
+
+Writer& Writer::value(bool b) {
+  before_value();
+  out_ += (b ? "true" : "false");
+  after_value();
+  return *this;
+}
+
+Writer& Writer::value(int64_t n) {
+  constexpr int64_t kMaxSafe = int64_t{1} << 53;
+  if (opts_.canonical && (n > kMaxSafe || n < -kMaxSafe)) {
+    return value(static_cast<double>(n));
+  }
+
+  before_value();
+  format(n);
+  after_value();
+  return *this;
+}
+
+Writer& Writer::value(uint64_t n) {
+  if (opts_.canonical && n > uint64_t{1} << 53) {
+    return value(static_cast<double>(n));
+  }
+
+  before_value();
+  format(n);
+  after_value();
+  return *this;
+}
+
+Writer& Writer::value(double d) {
+  if (opts_.canonical && !std::isfinite(d)) {
+    throw WriterException(kNonFiniteCanonical);
+  }
+
+  before_value();
+  if (!std::isfinite(d)) {
+    out_ += "null";
+  } else if (opts_.canonical) {
+    char buf[32];
+    out_.append(buf, format_canonical(d, buf));
+  } else {
+    format(d);
+  }
+
+  after_value();
+  return *this;
+}
+
+Writer& Writer::value(std::string_view s) {
+  before_value();
+  string(s);
+  after_value();
+  return *this;
+}
+
+Writer& Writer::value(const Value& value) {
+  write(value);
+  // The value may not outlive this call, so the sink must be done with any
+  // of its strings before returning.
+  if (referenced_) {
+    sink_->write(out_);
+    out_.clear();
+    sink_->flush();
+    referenced_ = false;
+  }
+
+  return *this;
+}
+
+void Writer::write(const Value& value) {
+  // Containers still being written, innermost last, so that deeply nested
+  // values don't recurse. Members come from `order` rather than `it` when
+  // canonical output reorders them.
+  struct Level {
+    Value::const_iterator it;
+    Value::const_iterator end;
+    std::vector<object_t::const_iterator> order = {};
+    size_t next = 0;
+  };
+
+  std::vector<Level> levels;
+  const Value* curr = &value;
+  while (curr) {
+    if (curr->is_raw()) {
+      write_raw(curr->raw());
+    } else {
+      curr->visit(
+          [this]() { this->value(nullptr); },
+          [this](bool b) { this->value(b); },
+          [this](int32_t i) { this->value(int64_t(i)); },
+          [this](double d) { this->value(d); },
+          [this](const std::string& s) {
+            before_value();
+            string(s, /*owned=*/true);
+            after_value();
+          },
+          [&](const array_t&) {
+            begin_array();
+            levels.push_back({curr->begin(), curr->end()});
+          },
+          [&](const object_t& o) {
+            begin_object();
+            levels.push_back({curr->begin(), curr->end()});
+            if (opts_.canonical && needs_canonical_sort(o)) {
+              levels.back().order = canonical_order(o);
+            }
+          });
+    }
+
+    // Moves on to the next child, closing the containers it finishes.
+    curr = nullptr;
+    while (!curr && !levels.empty()) {
+      Level& top = levels.back();
+      if (top.next < top.order.size()) {
+        object_t::const_iterator it = top.order[top.next++];
+        key(it->first);
+        curr = &it->second;
+      } else if (top.order.empty() && top.it != top.end) {
+        if (stack_.back().object) {
+          key(top.it.key());
+        }
+
+        curr = &*top.it;
+        ++top.it;
+      } else {
+        stack_.back().object ? end_object() : end_array();
+        levels.pop_back();
+      }
+    }
+  }
+}
+
+void Writer::write_raw(const std::string& raw) {
+  if (opts_.canonical) {
+    throw WriterException(kRawCanonical);
+  }
+
+  before_value();
+  if (opts_.ascii) {
+    // Well-formed JSON only has non-ASCII characters inside strings, so
+    // escaping them is all the text needs.
+    for (size_t i = 0; i < raw.size();) {
+      if (static_cast<uint8_t>(raw[i]) < 0x80) {
+        out_ += raw[i++];
+      } else {
+        utf8_escape(raw, i);
+      }
+    }
+  } else if (sink_ && raw.size() >= kMinReference) {
+    sink_->write(out_);
+    out_.clear();
+    sink_->write_ref(raw);
+    referenced_ = true;
+  } else {
+    out_ += raw;
+  }
+
+  after_value();
+}
+
+void Writer::before_value() {
+  if (done_) {
+    throw WriterException("value after the end of the document");
+  }
+
+  if (stack_.empty()) {
+    return;
+  }
+
+  Frame& frame = stack_.back();
+  if (frame.object) {
+    if (!frame.has_key) {
+      throw WriterException("value in an object without a key");
+    }
+
+    return;
+  }
+
+  // Array elements are preceded by their separator, so the writer never
+  // needs to know which element is the last.
+  if (frame.size > 0) {
+    out_ += ',';
+  }
+
+  indent();
+}
+
+void Writer::after_value() {
+  if (stack_.empty()) {
+    done_ = true;
+    if (sink_) {
+      sink_->write(out_);
+      out_.clear();
+      sink_->flush();
+      referenced_ = false;
+    }
+
+    return;
+  }
+
+  Frame& frame = stack_.back();
+  frame.size++;
+  frame.has_key = false;
+  if (sink_ && out_.size() >= kChunkSize) {
+    sink_->write(out_);
+    out_.clear();
+  }
+}
+
+void Writer::begin(bool object, char open) {
+  before_value();
+  out_ += open;
+  stack_.push_back(Frame{.object = object});
+}
+
+void Writer::end(bool object, char close) {
+  if (stack_.empty() || stack_.back().object != object) {
+    throw WriterException(std::string("unmatched '") + close + "'");
+  }
+
+  if (stack_.back().has_key) {
+    throw WriterException("object ended after a key without a value");
+  }
+
+  size_t size = stack_.back().size;
+  stack_.pop_back();
+  if (size > 0) {
+    if (opts_.trailing_commas) {
+      out_ += ',';
+    }
+
+    indent();
+  }
+
+  out_ += close;
+  after_value();
+}
+
+// Starts a new line at the current depth.
+void Writer::indent() {
+  if (!opts_.compact) {
+    out_ += '\n';
+    out_.append(stack_.size() * opts_.tab_width, ' ');
+  }
+}
+
+// Formats straight into the output buffer. std::to_chars picks the shortest
+// digits that round-trip and does not depend on the locale.
+template <typename T>
+void Writer::format(T n) {
+  constexpr size_t kMaxChars = 32;
+  size_t size = out_.size();
+  out_.resize(size + kMaxChars);
+  char* end =
+      std::to_chars(out_.data() + size, out_.data() + out_.size(), n).ptr;
+  out_.resize(static_cast<size_t>(end - out_.data()));
+}
+
+void Writer::u_escape(char32_t unit) {
+  constexpr char kHex[] = "0123456789abcdef";
+  out_ += "\\u";
+  for (int shift = 12; shift >= 0; shift -= 4) {
+    out_ += kHex[(unit >> shift) & 0xf];
+  }
+}
+
+void Writer::utf8_escape(std::string_view s, size_t& i) {
+  char32_t cp = decode_utf8(s, i);
+  if (cp >= 0x10000) {
+    cp -= 0x10000;
+    u_escape(0xd800 + (cp >> 10));
+    u_escape(0xdc00 + (cp & 0x3ff));
+  } else {
+    u_escape(cp);
+  }
+}
+
+void Writer::string(std::string_view s, bool owned) {
+  out_ += '"';
+  size_t i = 0;
+  size_t clean = find_escape(s, i, opts_.ascii);
+  if (owned && sink_ && clean == s.size() && s.size() >= kMinReference) {
+    sink_->write(out_);
+    out_.clear();
+    sink_->write_ref(s);
+    referenced_ = true;
+    out_ += '"';
+    return;
+  }
+
+  for (;; clean = find_escape(s, i, opts_.ascii)) {
+    out_.append(s, i, clean - i);
+    i = clean;
+    if (i == s.size()) {
+      break;
+    }
+
+    char c = s[i];
+    switch (c) {
+      case '"':
+        out_ += "\\\"";
+        break;
+      case '\\':
+        out_ += "\\\\";
+        break;
+      case '\b':
+        out_ += "\\b";
+        break;
+      case '\f':
+        out_ += "\\f";
+        break;
+      case '\n':
+        out_ += "\\n";
+        break;
+      case '\r':
+        out_ += "\\r";
+        break;
+      case '\t':
+        out_ += "\\t";
+        break;
+      default:
+        if (static_cast<uint8_t>(c) < 0x20) {
+          u_escape(static_cast<uint8_t>(c));
+          break;
+        }
+
+        utf8_escape(s, i);
+        continue;
+    }
+
+    i++;
+  }
+
+  out_ += '"';
+}
+
+}  // namespace json
+}  // namespace warren
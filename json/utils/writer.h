@@ -0,0 +1,184 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>  // nullptr_t, size_t
+#include <cstdint>  // int64_t, uint64_t
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "warren/json/value.h"
+
+namespace warren {
+namespace json {
+
+struct PrintOptions {
+  size_t tab_width = 2;
+  bool trailing_commas = false;
+  bool compact = false;
+  // Escape non-ASCII characters as \uXXXX so the output is pure ASCII.
+  bool ascii = false;
+  // RFC 8785 canonical form: compact, members ordered by UTF-16 code units,
+  // ECMAScript number formatting and minimal escaping. Overrides the options
+  // above. Non-finite numbers and Raw values throw WriterException. Members
+  // written through Writer::key are not reordered.
+  bool canonical = false;
+};
+
+// Destination for serialized output. Writers buffer internally and hand over
+// large chunks, so implementations need not buffer themselves.
+class Sink {
+ public:
+  virtual ~Sink() = default;
+
+  virtual void write(std::string_view data) = 0;
+
+  // Like write, but `data` stays alive and unchanged until the next flush(),
+  // so it may be kept by reference instead of copied.
+  virtual void write_ref(std::string_view data) { write(data); }
+
+  // Called when the writer is done with every buffer passed to write_ref.
+  virtual void flush() {}
+};
+
+class StreamSink final : public Sink {
+ public:
+  explicit StreamSink(std::ostream& os) : os_(os) {}
+
+  void write(std::string_view data) override;
+
+ private:
+  std::ostream& os_;
+};
+
+// Writes to a file descriptor, which stays owned by the caller. Throws
+// std::system_error if a write fails.
+class FdSink final : public Sink {
+ public:
+  explicit FdSink(int fd) : fd_(fd) {}
+
+  void write(std::string_view data) override;
+
+ private:
+  int fd_;
+};
+
+// Gathers output into an iovec list and flushes it to a file descriptor
+// with writev(2). Large strings in a Value are referenced rather than copied
+// into the output buffer. Small writes are copied into a fixed buffer and
+// larger ones are written out in place along with whatever is pending; the
+// list is also flushed once it holds IOV_MAX buffers. The descriptor stays
+// owned by the caller. Throws std::system_error if a write fails.
+class WritevSink final : public Sink {
+ public:
+  explicit WritevSink(int fd);
+
+  void write(std::string_view data) override;
+  void write_ref(std::string_view data) override;
+  void flush() override;
+
+ private:
+  void push(std::string_view data);
+
+  int fd_;
+  // Never grows, so the pending views into it stay valid until a flush.
+  std::string buffer_;
+  size_t used_ = 0;
+  std::vector<std::string_view> pending_;
+};
+
+// Exact length of to_string(value, opts), computed without producing the
+// output. It formats every number and scans every string, so it costs a good
+// part of a to_string; call it when the length is needed before the output,
+// as for a Content-Length, rather than to size a buffer.
+size_t serialized_size(const Value& value, const PrintOptions& opts = {});
+
+// Serializes a document as it is described, without building a Value first:
+//
+//   Writer writer(out);
+//   writer.begin_object().key("ids").begin_array();
+//   for (int64_t id : ids) {
+//     writer.value(id);
+//   }
+//   writer.end_array().end_object();
+//
+// Output is formatted exactly like to_string. Calls that would produce
+// malformed JSON, such as a value in an object without a key or a mismatched
+// end, throw WriterException. A Writer holds a single top-level value; when a
+// Sink is used, the output is flushed to it once that value is complete.
+class Writer {
+ public:
+  // Appends to `out`.
+  explicit Writer(std::string& out, const PrintOptions& opts = {});
+
+  explicit Writer(Sink& sink, const PrintOptions& opts = {});
+
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  Writer& begin_object();
+  Writer& end_object();
+  Writer& begin_array();
+  Writer& end_array();
+
+  Writer& key(std::string_view key);
+
+  Writer& value(std::nullptr_t);
+  Writer& value(bool b);
+  Writer& value(int64_t n);
+  Writer& value(uint64_t n);
+  // Non-finite doubles have no JSON spelling and are written as null.
+  Writer& value(double d);
+  Writer& value(std::string_view s);
+  Writer& value(const char* s) { return value(std::string_view(s)); }
+  Writer& value(const Value& value);
+
+  template <std::integral T>
+    requires(!std::same_as<T, bool>)
+  Writer& value(T n) {
+    if constexpr (std::is_signed_v<T>) {
+      return value(static_cast<int64_t>(n));
+    } else {
+      return value(static_cast<uint64_t>(n));
+    }
+  }
+
+  // True once a complete top-level value has been written.
+  bool done() const { return done_; }
+
+ private:
+  struct Frame {
+    bool object;
+    size_t size = 0;
+    bool has_key = false;
+  };
+
+  void before_value();
+  void after_value();
+  void write(const Value& value);
+  void write_raw(const std::string& raw);
+  void begin(bool object, char open);
+  void end(bool object, char close);
+  void indent();
+  // `owned` strings belong to a Value that outlives the current call to
+  // value(), so a large one can be handed to the sink by reference.
+  void string(std::string_view s, bool owned = false);
+  // Writes the UTF-8 sequence at s[i] as \u escapes, advancing `i` past it.
+  void utf8_escape(std::string_view s, size_t& i);
+  void u_escape(char32_t unit);
+
+  template <typename T>
+  void format(T n);
+
+  std::string buffer_;
+  std::string& out_;
+  Sink* sink_ = nullptr;
+  const PrintOptions opts_;
+  std::vector<Frame> stack_;
+  bool done_ = false;
+  bool referenced_ = false;
+};
+
+}  // namespace json
+}  // namespace warren
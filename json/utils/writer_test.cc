@@ -0,0 +1,324 @@
+#include "warren/json/utils/writer.h"
+
+#include <limits.h>  // IOV_MAX
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "warren/json/utils/exception.h"
+#include "warren/json/utils/parse.h"
+#include "warren/json/utils/to_string.h"
+
+namespace warren {
+namespace json {
+
+namespace {
+
+using ::testing::Eq;
+
+// Writes the same document as `R"({"a": [1, 2.5, "x"], "b": {}, "c": [],
+// "d": {"e": null, "f": true}})"_json` through the push API.
+void write_document(Writer& writer) {
+  writer.begin_object();
+  writer.key("a").begin_array().value(1).value(2.5).value("x").end_array();
+  writer.key("b").begin_object().end_object();
+  writer.key("c").begin_array().end_array();
+  writer.key("d").begin_object();
+  writer.key("e").value(nullptr).key("f").value(true);
+  writer.end_object();
+  writer.end_object();
+}
+
+TEST(WriterTest, MatchesToString) {
+  const Value value =
+      R"({"a": [1, 2.5, "x"], "b": {}, "c": [], "d": {"e": null, "f": true}})"
+      ""_json;
+  for (const PrintOptions& opts :
+       {PrintOptions{}, PrintOptions{.tab_width = 4},
+        PrintOptions{.trailing_commas = true}, PrintOptions{.compact = true}}) {
+    std::string out;
+    Writer writer(out, opts);
+    write_document(writer);
+    EXPECT_THAT(writer.done(), Eq(true));
+    EXPECT_THAT(out, Eq(to_string(value, opts)));
+  }
+}
+
+TEST(WriterTest, Scalars) {
+  std::string out;
+  Writer(out).value(std::numeric_limits<int64_t>::min());
+  EXPECT_THAT(out, Eq("-9223372036854775808"));
+
+  out.clear();
+  Writer(out).value(std::numeric_limits<uint64_t>::max());
+  EXPECT_THAT(out, Eq("18446744073709551615"));
+
+  out.clear();
+  Writer(out).value(uint8_t{7});
+  EXPECT_THAT(out, Eq("7"));
+
+  out.clear();
+  Writer(out).value("a\"b");
+  EXPECT_THAT(out, Eq(R"("a\"b")"));
+}
+
+TEST(WriterTest, MixesValues) {
+  std::string out;
+  Writer(out, PrintOptions{.compact = true})
+      .begin_array()
+      .value("[1, {\"a\": 2}]"_json)
+      .value(false)
+      .end_array();
+  EXPECT_THAT(out, Eq(R"([[1,{"a":2}],false])"));
+}
+
+TEST(WriterTest, SerializedSize) {
+  const Value values[] = {
+      "null"_json,
+      "-12"_json,
+      "0.30000000000000004"_json,
+      "[]"_json,
+      "{}"_json,
+      R"(["a\"b", "tab\t", "\u00e9", [[]], {"k": [1, {"x": false}]}])"_json,
+      R"({"a": [1, 2.5, "x"], "b": {}, "c": [], "d": {"e": null}})"_json,
+      Value("caf\xc3\xa9 \xf0\x9f\x98\x80 \x01\xff"),
+  };
+  for (const Value& value : values) {
+    for (const PrintOptions& opts :
+         {PrintOptions{}, PrintOptions{.tab_width = 3},
+          PrintOptions{.trailing_commas = true}, PrintOptions{.compact = true},
+          PrintOptions{.ascii = true}}) {
+      EXPECT_THAT(serialized_size(value, opts),
+                  Eq(to_string(value, opts).size()));
+    }
+  }
+}
+
+TEST(WriterTest, DeepNesting) {
+  constexpr size_t kDepth = 100000;
+  const std::string arrays =
+      std::string(kDepth, '[') + std::string(kDepth, ']');
+  EXPECT_THAT(to_string(parse(arrays), {.compact = true}), Eq(arrays));
+
+  std::string objects;
+  for (size_t i = 0; i < kDepth; i++) {
+    objects += R"({"k":)";
+  }
+
+  objects += "[1,{}]" + std::string(kDepth, '}');
+  const Value value = parse(objects);
+  EXPECT_THAT(to_string(value, {.compact = true}), Eq(objects));
+  EXPECT_THAT(serialized_size(value, {.compact = true}), Eq(objects.size()));
+}
+
+TEST(WriterTest, RawIsWrittenVerbatim) {
+  const Value value = object_t{{"a", Raw{"[1,  2]"}}, {"b", 3}};
+  EXPECT_THAT(to_string(value, PrintOptions{.compact = true}),
+              Eq(R"({"a":[1,  2],"b":3})"));
+  EXPECT_THAT(serialized_size(value), Eq(to_string(value).size()));
+}
+
+TEST(WriterTest, RawUnderAsciiAndCanonical) {
+  const Value value = array_t{Raw{"[\"caf\xc3\xa9\", \"\xf0\x9f\x98\x80\"]"}};
+  const PrintOptions ascii{.compact = true, .ascii = true};
+  EXPECT_THAT(to_string(value, ascii),
+              Eq(R"([["caf\u00e9", "\ud83d\ude00"]])"));
+  EXPECT_THAT(serialized_size(value, ascii),
+              Eq(to_string(value, ascii).size()));
+
+  const PrintOptions canonical{.canonical = true};
+  EXPECT_THROW(to_string(value, canonical), WriterException);
+  EXPECT_THROW(serialized_size(value, canonical), WriterException);
+  std::string out;
+  EXPECT_THROW(Writer(out, canonical).value(value), WriterException);
+}
+
+TEST(WriterTest, CanonicalNumbers) {
+  const PrintOptions canonical{.canonical = true};
+  auto print = [&canonical](double d) {
+    std::string out;
+    Writer(out, canonical).value(d);
+    return out;
+  };
+
+  EXPECT_THAT(print(0.0), Eq("0"));
+  EXPECT_THAT(print(-0.0), Eq("0"));
+  EXPECT_THAT(print(4.5), Eq("4.5"));
+  EXPECT_THAT(print(2e-3), Eq("0.002"));
+  EXPECT_THAT(print(1e-6), Eq("0.000001"));
+  EXPECT_THAT(print(1.234e-6), Eq("0.000001234"));
+  EXPECT_THAT(print(1e-7), Eq("1e-7"));
+  EXPECT_THAT(print(-1.5e-7), Eq("-1.5e-7"));
+  EXPECT_THAT(print(1e20), Eq("100000000000000000000"));
+  EXPECT_THAT(print(1e21), Eq("1e+21"));
+  EXPECT_THAT(print(123.456e5), Eq("12345600"));
+  EXPECT_THAT(print(333333333.3333333), Eq("333333333.3333333"));
+  EXPECT_THAT(print(1.5e300), Eq("1.5e+300"));
+  EXPECT_THAT(print(5e-324), Eq("5e-324"));
+  EXPECT_THAT(print(-1.7976931348623157e308), Eq("-1.7976931348623157e+308"));
+
+  std::string out;
+  Writer(out, canonical).value(int64_t{9007199254740993});
+  EXPECT_THAT(out, Eq("9007199254740992"));
+  EXPECT_THROW(print(std::numeric_limits<double>::infinity()), WriterException);
+
+  const Value nan = array_t{std::numeric_limits<double>::quiet_NaN()};
+  EXPECT_THAT(serialized_size(nan), Eq(to_string(nan).size()));
+  EXPECT_THROW(serialized_size(nan, canonical), WriterException);
+}
+
+TEST(WriterTest, Canonical) {
+  const PrintOptions canonical{.tab_width = 4,
+                               .trailing_commas = true,
+                               .ascii = true,
+                               .canonical = true};
+  const Value value = parse(R"({
+    "numbers": [333333333.33333329, 1.0E30, 4.50, 2.0e-3, 1.0e-27],
+    "string": "\u20ac$\u000F\u000aA'\u0042\u0022\u005c\\\"\/",
+    "literals": [null, true, false]
+  })");
+  EXPECT_THAT(to_string(value, canonical),
+              Eq("{\"literals\":[null,true,false],\"numbers\":["
+                 "333333333.3333333,1e+30,4.5,0.002,1e-27],\"string\":"
+                 "\"\xe2\x82\xac$\\u000f\\nA'B\\\"\\\\\\\\\\\"/\"}"));
+  EXPECT_THAT(serialized_size(value, canonical),
+              Eq(to_string(value, canonical).size()));
+}
+
+TEST(WriterTest, CanonicalRoundTrip) {
+  // Integral doubles up to 1e21 are spelled as integers, which parse back as
+  // doubles once they no longer fit in an int32.
+  const PrintOptions canonical{.canonical = true};
+  const Value value =
+      array_t{2147483648.0, -2147483649.0, 3000000000.0, 9007199254740992.0,
+              1e20, -1e20, 1e21, 1.5e300, 5e-324, 2147483647.0};
+  const std::string out = to_string(value, canonical);
+  EXPECT_THAT(out, Eq("[2147483648,-2147483649,3000000000,9007199254740992,"
+                      "100000000000000000000,-100000000000000000000,1e+21,"
+                      "1.5e+300,5e-324,2147483647]"));
+  EXPECT_THAT(parse(out), Eq(value));
+  EXPECT_THAT(to_string(parse(out), canonical), Eq(out));
+}
+
+TEST(WriterTest, CanonicalKeyOrder) {
+  // RFC 8785 3.2.3: sorted by UTF-16 code units, so U+1F600 (a surrogate
+  // pair) sorts before U+FB33 although its UTF-8 bytes sort after.
+  const Value value = object_t{{"\xef\xac\xb3", 1},      // U+FB33
+                               {"\xf0\x9f\x98\x80", 2},  // U+1F600
+                               {"\xe2\x82\xac", 3},      // U+20AC
+                               {"\xc3\xb6", 4},           // U+00F6
+                               {"\xc2\x80", 5},           // U+0080
+                               {"1", 6},
+                               {"\r", 7},
+                               {"\\u0041", 8}};
+  EXPECT_THAT(to_string(value, PrintOptions{.canonical = true}),
+              Eq("{\"\\r\":7,\"1\":6,\"\\\\u0041\":8,\"\xc2\x80\":5,"
+                 "\"\xc3\xb6\":4,\"\xe2\x82\xac\":3,\"\xf0\x9f\x98\x80\":2,"
+                 "\"\xef\xac\xb3\":1}"));
+}
+
+class StringSink : public Sink {
+ public:
+  void write(std::string_view data) override { out += data; }
+
+  std::string out;
+};
+
+TEST(WriterTest, FlushesToSinkWhenDone) {
+  StringSink sink;
+  Writer writer(sink, PrintOptions{.compact = true});
+  writer.begin_array().value(1);
+  EXPECT_THAT(sink.out, Eq(""));
+  writer.end_array();
+  EXPECT_THAT(sink.out, Eq("[1]"));
+}
+
+std::string read_all(std::FILE* file) {
+  std::rewind(file);
+  std::string res;
+  char buf[4096];
+  while (size_t n = std::fread(buf, 1, sizeof(buf), file)) {
+    res.append(buf, n);
+  }
+
+  return res;
+}
+
+TEST(WriterTest, WritevSink) {
+  Value value = array_t();
+  for (int32_t i = 0; i < 2000; i++) {
+    value.push_back(object_t{{"id", i}, {"blob", std::string(5000, 'x')}});
+  }
+
+  value.push_back(std::string(10000, 'y') + "\n");
+
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+  WritevSink sink(fileno(file));
+  Writer writer(sink);
+  writer.value(value);
+  EXPECT_THAT(read_all(file) == to_string(value), Eq(true));
+  std::fclose(file);
+}
+
+TEST(WriterTest, WritevSinkFlushesBeforeValueReturns) {
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+  WritevSink sink(fileno(file));
+  Writer writer(sink, PrintOptions{.compact = true});
+  writer.begin_array();
+  // The temporary is gone before the array ends.
+  writer.value(Value(std::string(5000, 'z')));
+  writer.end_array();
+  EXPECT_THAT(read_all(file), Eq("[\"" + std::string(5000, 'z') + "\"]"));
+  std::fclose(file);
+}
+
+TEST(WriterTest, WritevSinkBoundsPendingOutput) {
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+  WritevSink sink(fileno(file));
+  sink.write("a");
+  EXPECT_THAT(read_all(file), Eq(""));
+
+  // A large write goes out at once instead of being copied.
+  const std::string large(100000, 'b');
+  sink.write(large);
+  EXPECT_THAT(read_all(file) == "a" + large, Eq(true));
+
+  // So does a full iovec list.
+  const size_t iov_max = IOV_MAX;
+  const std::string ref = "c";
+  for (size_t i = 0; i < iov_max; i++) {
+    sink.write_ref(ref);
+  }
+
+  EXPECT_THAT(read_all(file).size(), Eq(1 + large.size() + iov_max));
+  sink.write("d");
+  sink.flush();
+  EXPECT_THAT(read_all(file).substr(1 + large.size()),
+              Eq(std::string(iov_max, 'c') + "d"));
+  std::fclose(file);
+}
+
+TEST(WriterTest, RejectsMalformedStructure) {
+  std::string out;
+  EXPECT_THROW(Writer(out).begin_object().value(1), WriterException);
+  EXPECT_THROW(Writer(out).begin_array().key("a"), WriterException);
+  EXPECT_THROW(Writer(out).key("a"), WriterException);
+  EXPECT_THROW(Writer(out).begin_object().key("a").key("b"), WriterException);
+  EXPECT_THROW(Writer(out).begin_object().key("a").end_object(),
+               WriterException);
+  EXPECT_THROW(Writer(out).begin_array().end_object(), WriterException);
+  EXPECT_THROW(Writer(out).end_array(), WriterException);
+  EXPECT_THROW(Writer(out).value(1).value(2), WriterException);
+}
+
+}  // namespace
+
+}  // namespace json
+}  // namespace warren
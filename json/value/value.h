@@ -2,8 +2,16 @@
 
 #include <cstddef>  // nullptr_t, size_t
 #include <cstdint>  // int32_t
+#include <functional>
+#include <iterator>
 #include <map>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "warren/json/utils/exception.h"
@@ -13,37 +21,122 @@ namespace json {
 
 class Value;
 using array_t = std::vector<Value>;
-using object_t = std::map<std::string, Value>;
+using object_t = std::map<std::string, Value, std::less<>>;
+
+// Already-serialized JSON to embed in a Value as is. It is printed byte for
+// byte, apart from escaping non-ASCII characters when asked to. See json::raw
+// for a checked constructor and json::expand to turn it into a tree. The
+// codecs, the frozen format, columns, diff, patches and schemas parse Raw
+// values as needed; a JSONPath query that looks inside one throws
+// BadAccessException.
+struct Raw {
+  std::string json;
+};
 
 class Value {
  public:
+  // Walks the elements of an array or the values of an object. The container
+  // type is resolved once in `begin()`; stepping is a plain vector or map
+  // iterator step.
+  template <bool Const>
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const Value*, Value*>;
+    using reference = std::conditional_t<Const, const Value&, Value&>;
+
+    Iterator() noexcept = default;
+
+    template <bool C = Const, typename = std::enable_if_t<C>>
+    Iterator(const Iterator<false>& other) noexcept
+        : a_(other.a_), o_(other.o_), is_array_(other.is_array_) {}
+
+    reference operator*() const noexcept {
+      return is_array_ ? *a_ : o_->second;
+    }
+
+    pointer operator->() const noexcept { return &**this; }
+
+    Iterator& operator++() noexcept {
+      if (is_array_) {
+        ++a_;
+      } else {
+        ++o_;
+      }
+
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+      Iterator it = *this;
+      ++*this;
+      return it;
+    }
+
+    Iterator& operator--() noexcept {
+      if (is_array_) {
+        --a_;
+      } else {
+        --o_;
+      }
+
+      return *this;
+    }
+
+    Iterator operator--(int) noexcept {
+      Iterator it = *this;
+      --*this;
+      return it;
+    }
+
+    bool operator==(const Iterator& other) const noexcept {
+      return is_array_ ? a_ == other.a_ : o_ == other.o_;
+    }
+
+    // Key of the current object member.
+    const std::string& key() const {
+      if (is_array_) {
+        throw BadAccessException("expected type object, got array");
+      }
+
+      return o_->first;
+    }
+
+   private:
+    friend class Value;
+    template <bool>
+    friend class Iterator;
+
+    using array_iterator = std::conditional_t<Const, array_t::const_iterator,
+                                              array_t::iterator>;
+    using object_iterator = std::conditional_t<Const, object_t::const_iterator,
+                                               object_t::iterator>;
+
+    explicit Iterator(array_iterator it) noexcept : a_(it), is_array_(true) {}
+
+    explicit Iterator(object_iterator it) noexcept : o_(it), is_array_(false) {}
+
+    array_iterator a_;
+    object_iterator o_;
+    bool is_array_ = false;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
   Value() noexcept : type_(Type::JSON_NULL) {}
 
   ~Value() noexcept { destroy(); }
 
-  Value(const Value& other) {
-    switch (other.type_) {
-      case Type::ARRAY:
-        ::new ((void*)(&a_)) array_t(other.a_);
-        break;
-      case Type::BOOLEAN:
-        b_ = other.b_;
-        break;
-      case Type::JSON_NULL:
-        break;
-      case Type::INTEGRAL:
-      case Type::DOUBLE:
-        n_ = other.n_;
-        break;
-      case Type::OBJECT:
-        ::new ((void*)(&o_)) object_t(other.o_);
-        break;
-      case Type::STRING:
-        ::new ((void*)(&s_)) std::string(other.s_);
-        break;
+  Value(const Value& other) : type_(Type::JSON_NULL) {
+    try {
+      copy_from(other);
+    } catch (...) {
+      destroy();
+      throw;
     }
-
-    type_ = other.type_;
   }
 
   Value(Value&& other) noexcept {
@@ -64,6 +157,7 @@ class Value {
         ::new ((void*)(&o_)) object_t(std::move(other.o_));
         break;
       case Type::STRING:
+      case Type::RAW:
         ::new ((void*)(&s_)) std::string(std::move(other.s_));
         break;
     }
@@ -80,12 +174,12 @@ class Value {
 
   Value(double n) noexcept : n_(n), type_(Type::DOUBLE) {}
 
-  Value(array_t a) {
+  Value(array_t a) noexcept {
     ::new ((void*)(&a_)) array_t(std::move(a));
     type_ = Type::ARRAY;
   }
 
-  Value(object_t o) {
+  Value(object_t o) noexcept {
     ::new ((void*)(&o_)) object_t(std::move(o));
     type_ = Type::OBJECT;
   }
@@ -100,31 +194,15 @@ class Value {
     type_ = Type::STRING;
   }
 
+  Value(Raw raw) noexcept {
+    ::new ((void*)(&s_)) std::string(std::move(raw.json));
+    type_ = Type::RAW;
+  }
+
   Value& operator=(const Value& other) {
     if (this != &other) {
-      destroy();
-      switch (other.type_) {
-        case Type::ARRAY:
-          ::new ((void*)(&a_)) array_t(other.a_);
-          break;
-        case Type::BOOLEAN:
-          b_ = other.b_;
-          break;
-        case Type::JSON_NULL:
-          break;
-        case Type::INTEGRAL:
-        case Type::DOUBLE:
-          n_ = other.n_;
-          break;
-        case Type::OBJECT:
-          ::new ((void*)(&o_)) object_t(other.o_);
-          break;
-        case Type::STRING:
-          ::new ((void*)(&s_)) std::string(other.s_);
-          break;
-      }
-
-      type_ = other.type_;
+      Value copy(other);
+      *this = std::move(copy);
     }
 
     return *this;
@@ -150,6 +228,7 @@ class Value {
           ::new ((void*)(&o_)) object_t(std::move(other.o_));
           break;
         case Type::STRING:
+        case Type::RAW:
           ::new ((void*)(&s_)) std::string(std::move(other.s_));
           break;
       }
@@ -217,30 +296,25 @@ class Value {
   }
 
   bool operator==(const Value& other) const {
-    bool is_number =
-        ((type_ == Type::INTEGRAL && other.type_ == Type::DOUBLE) ||
-         (type_ == Type::DOUBLE && other.type_ == Type::INTEGRAL));
-    if (type_ != other.type_ && !is_number) {
-      return false;
+    if (!is_container() || type_ != other.type_) {
+      return equal_scalar(other);
     }
 
-    switch (type_) {
-      case Type::ARRAY:
-        return a_ == other.a_;
-      case Type::BOOLEAN:
-        return b_ == other.b_;
-      case Type::JSON_NULL:
+    std::vector<std::pair<const Value*, const Value*>> pending;
+    const Value* lhs = this;
+    const Value* rhs = &other;
+    while (true) {
+      if (!lhs->equal_children(*rhs, pending)) {
+        return false;
+      }
+
+      if (pending.empty()) {
         return true;
-      case Type::INTEGRAL:
-      case Type::DOUBLE:
-        return n_ == other.n_;
-      case Type::OBJECT:
-        return o_ == other.o_;
-      case Type::STRING:
-        return s_ == other.s_;
-    }
+      }
 
-    __builtin_unreachable();
+      std::tie(lhs, rhs) = pending.back();
+      pending.pop_back();
+    }
   }
 
   bool operator==(nullptr_t) const noexcept { return type_ == Type::JSON_NULL; }
@@ -265,6 +339,93 @@ class Value {
     return type_ == Type::STRING && s == s_;
   }
 
+  // type queries
+  bool is_null() const noexcept { return type_ == Type::JSON_NULL; }
+
+  bool is_boolean() const noexcept { return type_ == Type::BOOLEAN; }
+
+  bool is_number() const noexcept {
+    return type_ == Type::INTEGRAL || type_ == Type::DOUBLE;
+  }
+
+  bool is_integral() const noexcept { return type_ == Type::INTEGRAL; }
+
+  bool is_double() const noexcept { return type_ == Type::DOUBLE; }
+
+  bool is_string() const noexcept { return type_ == Type::STRING; }
+
+  bool is_array() const noexcept { return type_ == Type::ARRAY; }
+
+  bool is_object() const noexcept { return type_ == Type::OBJECT; }
+
+  // A Raw value is none of the above until it is expanded.
+  bool is_raw() const noexcept { return type_ == Type::RAW; }
+
+  const std::string& raw() const {
+    assert_type(Type::RAW);
+    return s_;
+  }
+
+  // Non-throwing accessors. `get_if` hands out a pointer to the stored
+  // `bool`, `double`, `std::string`, `array_t` or `object_t`, or nullptr on a
+  // type mismatch. `try_get` and `value_or` copy scalars out (strings as a
+  // `std::string_view` into this value).
+  template <typename T>
+  const T* get_if() const noexcept {
+    if constexpr (std::is_same_v<T, bool>) {
+      return type_ == Type::BOOLEAN ? &b_ : nullptr;
+    } else if constexpr (std::is_same_v<T, double>) {
+      return type_ == Type::DOUBLE ? &n_ : nullptr;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      return type_ == Type::STRING ? &s_ : nullptr;
+    } else if constexpr (std::is_same_v<T, array_t>) {
+      return type_ == Type::ARRAY ? &a_ : nullptr;
+    } else if constexpr (std::is_same_v<T, object_t>) {
+      return type_ == Type::OBJECT ? &o_ : nullptr;
+    } else {
+      static_assert(sizeof(T) == 0, "unsupported get_if type");
+    }
+  }
+
+  template <typename T>
+  T* get_if() noexcept {
+    return const_cast<T*>(static_cast<const Value*>(this)->get_if<T>());
+  }
+
+  template <typename T>
+  std::optional<T> try_get() const noexcept {
+    if constexpr (std::is_same_v<T, bool>) {
+      if (type_ == Type::BOOLEAN) {
+        return b_;
+      }
+    } else if constexpr (std::is_same_v<T, int32_t>) {
+      if (type_ == Type::INTEGRAL) {
+        return int32_t(n_);
+      }
+    } else if constexpr (std::is_same_v<T, double>) {
+      if (type_ == Type::DOUBLE) {
+        return n_;
+      }
+    } else if constexpr (std::is_same_v<T, float>) {
+      if (type_ == Type::DOUBLE) {
+        return float(n_);
+      }
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+      if (type_ == Type::STRING) {
+        return std::string_view(s_);
+      }
+    } else {
+      static_assert(sizeof(T) == 0, "unsupported try_get type");
+    }
+
+    return std::nullopt;
+  }
+
+  template <typename T>
+  T value_or(T fallback) const noexcept {
+    return try_get<T>().value_or(fallback);
+  }
+
   // containers
   size_t size() const {
     switch (type_) {
@@ -294,6 +455,89 @@ class Value {
     __builtin_unreachable();
   }
 
+  iterator begin() {
+    switch (type_) {
+      case Type::ARRAY:
+        return iterator(a_.begin());
+      case Type::OBJECT:
+        return iterator(o_.begin());
+      default:
+        throw NonIterableTypeException(
+            "expected container type (array, object), got " + type(type_));
+    }
+
+    __builtin_unreachable();
+  }
+
+  iterator end() {
+    switch (type_) {
+      case Type::ARRAY:
+        return iterator(a_.end());
+      case Type::OBJECT:
+        return iterator(o_.end());
+      default:
+        throw NonIterableTypeException(
+            "expected container type (array, object), got " + type(type_));
+    }
+
+    __builtin_unreachable();
+  }
+
+  const_iterator begin() const {
+    switch (type_) {
+      case Type::ARRAY:
+        return const_iterator(a_.cbegin());
+      case Type::OBJECT:
+        return const_iterator(o_.cbegin());
+      default:
+        throw NonIterableTypeException(
+            "expected container type (array, object), got " + type(type_));
+    }
+
+    __builtin_unreachable();
+  }
+
+  const_iterator end() const {
+    switch (type_) {
+      case Type::ARRAY:
+        return const_iterator(a_.cend());
+      case Type::OBJECT:
+        return const_iterator(o_.cend());
+      default:
+        throw NonIterableTypeException(
+            "expected container type (array, object), got " + type(type_));
+    }
+
+    __builtin_unreachable();
+  }
+
+  const_iterator cbegin() const { return begin(); }
+
+  const_iterator cend() const { return end(); }
+
+  // Checked once, then iterated as the underlying container:
+  //   for (const Value& v : value.elements()) { ... }
+  //   for (const auto& [k, v] : value.items()) { ... }
+  array_t& elements() {
+    assert_iterable(Type::ARRAY);
+    return a_;
+  }
+
+  const array_t& elements() const {
+    assert_iterable(Type::ARRAY);
+    return a_;
+  }
+
+  object_t& items() {
+    assert_iterable(Type::OBJECT);
+    return o_;
+  }
+
+  const object_t& items() const {
+    assert_iterable(Type::OBJECT);
+    return o_;
+  }
+
   // array
   template <typename T>
   typename std::enable_if_t<std::is_integral_v<T>, Value&> operator[](T i) {
@@ -309,16 +553,21 @@ class Value {
   }
 
   void push_back(const Value& value) {
-    if (type_ == Type::JSON_NULL) {
-      destroy();
-      ::new ((void*)(&a_)) array_t();
-      type_ = Type::ARRAY;
-    }
-
-    assert_type(Type::ARRAY);
+    make_array();
     a_.push_back(value);
   }
 
+  void push_back(Value&& value) {
+    make_array();
+    a_.push_back(std::move(value));
+  }
+
+  template <typename... Args>
+  Value& emplace_back(Args&&... args) {
+    make_array();
+    return a_.emplace_back(std::forward<Args>(args)...);
+  }
+
   void erase(array_t::const_iterator cit) {
     assert_type(Type::ARRAY);
     a_.erase(cit);
@@ -326,55 +575,77 @@ class Value {
 
   // object
   template <typename T>
-  typename std::enable_if_t<std::is_convertible_v<T, std::string>, Value&>
+  typename std::enable_if_t<std::is_convertible_v<T, std::string_view>, Value&>
   operator[](const T& key) {
-    if (type_ == Type::JSON_NULL) {
-      destroy();
-      ::new ((void*)(&o_)) object_t();
-      type_ = Type::OBJECT;
-    }
-
-    assert_type(Type::OBJECT);
-    return o_[key];
+    return try_emplace(std::string_view(key)).first->second;
   }
 
   template <typename T>
-  typename std::enable_if_t<std::is_convertible_v<T, std::string>, const Value&>
+  typename std::enable_if_t<std::is_convertible_v<T, std::string_view>,
+                            const Value&>
   at(const T& key) const {
     assert_type(Type::OBJECT);
-    return o_.at(key);
+    auto it = o_.find(std::string_view(key));
+    if (it == o_.end()) {
+      throw std::out_of_range("key not found: " + std::string(key));
+    }
+
+    return it->second;
   }
 
-  void insert(const std::string& key, const Value& value) {
-    if (type_ == Type::JSON_NULL) {
-      destroy();
-      ::new ((void*)(&o_)) object_t();
-      type_ = Type::OBJECT;
+  // Returns nullptr if this is not an object or `key` is absent. The map
+  // compares transparently, so no std::string is built for the lookup; for
+  // keys read from many objects, hold them as std::string_view constants to
+  // skip the strlen too.
+  const Value* find(std::string_view key) const noexcept {
+    if (type_ != Type::OBJECT) {
+      return nullptr;
     }
 
-    assert_type(Type::OBJECT);
-    o_.insert({key, value});
+    auto it = o_.find(key);
+    return it == o_.end() ? nullptr : &it->second;
   }
 
-  void erase(const std::string& key) {
-    assert_type(Type::OBJECT);
-    o_.erase(key);
+  Value* find(std::string_view key) noexcept {
+    return const_cast<Value*>(static_cast<const Value*>(this)->find(key));
   }
 
-  const Value& at(const char* key) const {
-    assert_type(Type::OBJECT);
-    return o_.at(key);
+  bool contains(std::string_view key) const noexcept {
+    return find(key) != nullptr;
   }
 
-  void insert(const char* key, const Value& value) {
-    if (type_ == Type::JSON_NULL) {
-      destroy();
-      ::new ((void*)(&o_)) object_t();
-      type_ = Type::OBJECT;
+  void insert(std::string_view key, const Value& value) {
+    (void)try_emplace(key, value);
+  }
+
+  void insert(std::string_view key, Value&& value) {
+    (void)try_emplace(key, std::move(value));
+  }
+
+  // Constructs the value in place if `key` is absent; otherwise leaves the
+  // existing value (and `args`) untouched. The key string is only allocated
+  // when a new entry is created.
+  template <typename... Args>
+  std::pair<object_t::iterator, bool> try_emplace(std::string_view key,
+                                                  Args&&... args) {
+    make_object();
+    auto it = o_.lower_bound(key);
+    if (it != o_.end() && it->first == key) {
+      return {it, false};
     }
 
+    it = o_.emplace_hint(it, std::piecewise_construct,
+                         std::forward_as_tuple(key),
+                         std::forward_as_tuple(std::forward<Args>(args)...));
+    return {it, true};
+  }
+
+  void erase(std::string_view key) {
     assert_type(Type::OBJECT);
-    o_.insert({key, value});
+    auto it = o_.find(key);
+    if (it != o_.end()) {
+      o_.erase(it);
+    }
   }
 
   template <class NullHandler, class BooleanHandler, class IntegralHandler,
@@ -399,15 +670,38 @@ class Value {
         return std::forward<ArrayHandler>(array_fn)(a_);
       case Type::OBJECT:
         return std::forward<ObjectHandler>(object_fn)(o_);
+      case Type::RAW:
+        throw BadAccessException("raw value must be expanded to be visited");
     }
 
     __builtin_unreachable();
   }
 
  private:
-  enum Type { ARRAY, BOOLEAN, JSON_NULL, INTEGRAL, DOUBLE, OBJECT, STRING };
+  enum Type {
+    ARRAY,
+    BOOLEAN,
+    JSON_NULL,
+    INTEGRAL,
+    DOUBLE,
+    OBJECT,
+    STRING,
+    RAW
+  };
 
+  // Copy, equality and destruction walk nested containers with an explicit
+  // worklist instead of recursing through the element constructors,
+  // comparisons and destructors, so they run in bounded stack depth on
+  // arbitrarily deep trees.
   void destroy() noexcept {
+    if (is_container()) {
+      release_children();
+    }
+
+    release();
+  }
+
+  void release() noexcept {
     switch (type_) {
       case Type::ARRAY:
         a_.~array_t();
@@ -416,6 +710,7 @@ class Value {
         o_.~object_t();
         break;
       case Type::STRING:
+      case Type::RAW:
         s_.std::string::~string();
         break;
       default:
@@ -425,6 +720,195 @@ class Value {
     type_ = Type::JSON_NULL;
   }
 
+  // Frees nested containers one level at a time. Each container popped off
+  // the worklist first hands its own nested containers over, so its
+  // destructor only ever sees leaves.
+  void release_children() noexcept {
+    try {
+      array_t pending;
+      detach_children(pending);
+      while (!pending.empty()) {
+        Value value = std::move(pending.back());
+        pending.pop_back();
+        value.detach_children(pending);
+        value.release();
+      }
+    } catch (...) {
+      // Out of memory growing the worklist; the rest is freed recursively.
+    }
+  }
+
+  void detach_children(array_t& pending) {
+    auto detach = [&pending](Value& child) {
+      if (child.is_container() && !child.empty()) {
+        pending.push_back(std::move(child));
+      }
+    };
+
+    if (type_ == Type::ARRAY) {
+      for (Value& child : a_) {
+        detach(child);
+      }
+    } else if (type_ == Type::OBJECT) {
+      for (auto& [_, child] : o_) {
+        detach(child);
+      }
+    }
+  }
+
+  void copy_from(const Value& other) {
+    std::vector<std::pair<const Value*, Value*>> pending;
+    const Value* src = &other;
+    Value* dst = this;
+    while (true) {
+      dst->copy_shallow(*src, pending);
+      if (pending.empty()) {
+        return;
+      }
+
+      std::tie(src, dst) = pending.back();
+      pending.pop_back();
+    }
+  }
+
+  // Copies a scalar, or builds `other`'s container with null children and
+  // queues the nested containers among them. `type_` is only set once the
+  // member is constructed, so a throw leaves a destructible tree behind.
+  void copy_shallow(const Value& other,
+                    std::vector<std::pair<const Value*, Value*>>& pending) {
+    auto copy_child = [&pending](const Value& src, Value& dst) {
+      if (src.is_container()) {
+        pending.emplace_back(&src, &dst);
+      } else {
+        dst.copy_shallow(src, pending);
+      }
+    };
+
+    switch (other.type_) {
+      case Type::ARRAY:
+        ::new ((void*)(&a_)) array_t(other.a_.size());
+        type_ = Type::ARRAY;
+        for (size_t i = 0; i < other.a_.size(); i++) {
+          copy_child(other.a_[i], a_[i]);
+        }
+        break;
+      case Type::BOOLEAN:
+        b_ = other.b_;
+        type_ = other.type_;
+        break;
+      case Type::JSON_NULL:
+        break;
+      case Type::INTEGRAL:
+      case Type::DOUBLE:
+        n_ = other.n_;
+        type_ = other.type_;
+        break;
+      case Type::OBJECT:
+        ::new ((void*)(&o_)) object_t();
+        type_ = Type::OBJECT;
+        for (const auto& [key, value] : other.o_) {
+          copy_child(value, o_.emplace_hint(o_.end(), key, nullptr)->second);
+        }
+        break;
+      case Type::STRING:
+      case Type::RAW:
+        ::new ((void*)(&s_)) std::string(other.s_);
+        type_ = other.type_;
+        break;
+    }
+  }
+
+  // Compares the children of two containers of the same type, queueing pairs
+  // of nested containers.
+  bool equal_children(
+      const Value& other,
+      std::vector<std::pair<const Value*, const Value*>>& pending) const {
+    auto equal_child = [&pending](const Value& lhs, const Value& rhs) {
+      if (lhs.is_container() && lhs.type_ == rhs.type_) {
+        pending.emplace_back(&lhs, &rhs);
+        return true;
+      }
+
+      return lhs.equal_scalar(rhs);
+    };
+
+    if (type_ == Type::ARRAY) {
+      if (a_.size() != other.a_.size()) {
+        return false;
+      }
+
+      for (size_t i = 0; i < a_.size(); i++) {
+        if (!equal_child(a_[i], other.a_[i])) {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    if (o_.size() != other.o_.size()) {
+      return false;
+    }
+
+    for (auto lhs = o_.begin(), rhs = other.o_.begin(); lhs != o_.end();
+         ++lhs, ++rhs) {
+      if (lhs->first != rhs->first || !equal_child(lhs->second, rhs->second)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool equal_scalar(const Value& other) const {
+    bool is_number =
+        ((type_ == Type::INTEGRAL && other.type_ == Type::DOUBLE) ||
+         (type_ == Type::DOUBLE && other.type_ == Type::INTEGRAL));
+    if (type_ != other.type_ && !is_number) {
+      return false;
+    }
+
+    switch (type_) {
+      case Type::BOOLEAN:
+        return b_ == other.b_;
+      case Type::JSON_NULL:
+        return true;
+      case Type::INTEGRAL:
+      case Type::DOUBLE:
+        return n_ == other.n_;
+      case Type::STRING:
+      case Type::RAW:
+        return s_ == other.s_;
+      case Type::ARRAY:
+      case Type::OBJECT:
+        return *this == other;
+    }
+
+    __builtin_unreachable();
+  }
+
+  bool is_container() const noexcept {
+    return type_ == Type::ARRAY || type_ == Type::OBJECT;
+  }
+
+  void make_array() {
+    if (type_ == Type::JSON_NULL) {
+      ::new ((void*)(&a_)) array_t();
+      type_ = Type::ARRAY;
+    }
+
+    assert_type(Type::ARRAY);
+  }
+
+  void make_object() {
+    if (type_ == Type::JSON_NULL) {
+      ::new ((void*)(&o_)) object_t();
+      type_ = Type::OBJECT;
+    }
+
+    assert_type(Type::OBJECT);
+  }
+
   void assert_type(Type expected) const {
     if (type_ != expected) {
       throw BadAccessException("expected type " + type(expected) + ", got " +
@@ -432,6 +916,13 @@ class Value {
     }
   }
 
+  void assert_iterable(Type expected) const {
+    if (type_ != expected) {
+      throw NonIterableTypeException("expected type " + type(expected) +
+                                     ", got " + type(type_));
+    }
+  }
+
   std::string type(Type type) const {
     switch (type) {
       case ARRAY:
@@ -447,6 +938,8 @@ class Value {
         return "object";
       case STRING:
         return "string";
+      case RAW:
+        return "raw";
     }
 
     __builtin_unreachable();
@@ -10,6 +10,7 @@ namespace {
 
 using ::testing::DoubleEq;
 using ::testing::Eq;
+using ::testing::Ne;
 using ::testing::Throws;
 
 TEST(ValueTest, DefaultConstructor) {
@@ -131,6 +132,98 @@ TEST(ValueTest, ObjectInsert) {
   EXPECT_THAT(v["age"], Eq(42));
 }
 
+TEST(ValueTest, ArrayPushBackMove) {
+  Value v;
+  Value s = "moved";
+  v.push_back(std::move(s));
+
+  EXPECT_THAT(v.size(), Eq(1));
+  EXPECT_THAT(v[0], Eq("moved"));
+  EXPECT_THAT(s, Eq(nullptr));
+}
+
+TEST(ValueTest, ArrayEmplaceBack) {
+  Value v;
+  EXPECT_THAT(v.emplace_back(std::string("emplaced")), Eq("emplaced"));
+  EXPECT_THAT(v.emplace_back(array_t{1, 2}), Eq(array_t{1, 2}));
+
+  EXPECT_THAT(v.size(), Eq(2));
+  EXPECT_THAT(v[0], Eq("emplaced"));
+}
+
+TEST(ValueTest, ObjectTryEmplace) {
+  Value v;
+  auto [it, inserted] = v.try_emplace(std::string_view("key"), "value");
+  EXPECT_TRUE(inserted);
+  EXPECT_THAT(it->second, Eq("value"));
+
+  auto [existing, reinserted] = v.try_emplace("key", "other");
+  EXPECT_FALSE(reinserted);
+  EXPECT_THAT(existing->second, Eq("value"));
+  EXPECT_THAT(v.size(), Eq(1));
+}
+
+TEST(ValueTest, ObjectInsertMove) {
+  Value v;
+  Value s = "moved";
+  std::string key = "key";
+  v.insert(key, std::move(s));
+  v.insert(std::string_view("key"), "ignored");
+
+  EXPECT_THAT(v.size(), Eq(1));
+  EXPECT_THAT(v.at(std::string_view("key")), Eq("moved"));
+  EXPECT_THAT(s, Eq(nullptr));
+}
+
+TEST(ValueTest, DeepCopyIsIndependent) {
+  Value original = object_t{{"a", array_t{1, object_t{{"b", "c"}}}}};
+  Value copy = original;
+  EXPECT_THAT(copy, Eq(original));
+
+  copy["a"][1]["b"] = "d";
+  EXPECT_THAT(original["a"][1]["b"], Eq("c"));
+  EXPECT_THAT(copy, ::testing::Ne(original));
+}
+
+TEST(ValueTest, Equality) {
+  EXPECT_THAT(Value(array_t{1, 2.0}), Eq(Value(array_t{1.0, 2})));
+  EXPECT_THAT(Value(array_t{1, array_t{}}),
+              ::testing::Ne(Value(array_t{1, object_t{}})));
+  EXPECT_THAT(Value(object_t{{"a", 1}}),
+              ::testing::Ne(Value(object_t{{"b", 1}})));
+  EXPECT_THAT(Value(object_t{{"a", array_t{1}}}),
+              ::testing::Ne(Value(object_t{{"a", array_t{1, 2}}})));
+  EXPECT_THAT(Value(array_t{}), ::testing::Ne(Value(object_t{})));
+  EXPECT_THAT(Value(array_t{}), ::testing::Ne(Value()));
+}
+
+TEST(ValueTest, CopyAssignmentFromChild) {
+  Value v = object_t{{"child", object_t{{"leaf", 1}}}};
+  v = v["child"];
+
+  EXPECT_THAT(v, Eq(object_t{{"leaf", 1}}));
+}
+
+TEST(ValueTest, DeeplyNested) {
+  constexpr size_t kDepth = 1'000'000;
+  Value root;
+  Value* curr = &root;
+  for (size_t i = 0; i < kDepth; i++) {
+    curr = &(i % 2 ? (*curr)["k"] : curr->emplace_back());
+  }
+  *curr = "leaf";
+
+  Value copy = root;
+  EXPECT_TRUE(copy == root);
+
+  curr = &copy;
+  for (size_t i = 0; i < kDepth; i++) {
+    curr = &(i % 2 ? (*curr)["k"] : (*curr)[0]);
+  }
+  *curr = "changed";
+  EXPECT_FALSE(copy == root);
+}
+
 TEST(ValueTest, TypeReassignment) {
   Value v = "string";
   EXPECT_THAT(v, Eq("string"));
@@ -212,6 +305,131 @@ TEST(ValueTest, ObjectIteration) {
   EXPECT_THAT(sum, Eq(6));
 }
 
+TEST(ValueTest, ArrayIterator) {
+  Value v = array_t{1, 2, 3};
+
+  int32_t sum = 0;
+  for (const Value& item : std::as_const(v)) {
+    sum += (int32_t)item;
+  }
+
+  EXPECT_THAT(sum, Eq(6));
+
+  for (Value& item : v) {
+    item = (int32_t)item * 2;
+  }
+
+  EXPECT_THAT(v, Eq(array_t{2, 4, 6}));
+}
+
+TEST(ValueTest, ObjectIterator) {
+  Value v = object_t{{"a", 1}, {"b", 2}, {"c", 3}};
+
+  std::string keys;
+  int32_t sum = 0;
+  for (Value::const_iterator it = v.begin(); it != v.end(); ++it) {
+    keys += it.key();
+    sum += (int32_t)*it;
+  }
+
+  EXPECT_THAT(keys, Eq("abc"));
+  EXPECT_THAT(sum, Eq(6));
+}
+
+TEST(ValueTest, IteratorKeyOnArrayThrows) {
+  Value v = array_t{1};
+  EXPECT_THAT([&v]() { (void)v.begin().key(); }, Throws<BadAccessException>());
+}
+
+TEST(ValueTest, ItemsAndElements) {
+  Value v = object_t{{"a", array_t{1, 2}}, {"b", array_t{3}}};
+
+  int32_t sum = 0;
+  for (const auto& [_, value] : v.items()) {
+    for (const Value& item : value.elements()) {
+      sum += (int32_t)item;
+    }
+  }
+
+  EXPECT_THAT(sum, Eq(6));
+}
+
+TEST(ValueTest, NonIterableThrows) {
+  Value v = 1;
+  EXPECT_THAT([&v]() { (void)v.begin(); }, Throws<NonIterableTypeException>());
+  EXPECT_THAT([&v]() { (void)v.end(); }, Throws<NonIterableTypeException>());
+  EXPECT_THAT([&v]() { (void)v.items(); }, Throws<NonIterableTypeException>());
+  EXPECT_THAT([&v]() { (void)v.elements(); },
+              Throws<NonIterableTypeException>());
+  EXPECT_THAT([]() { (void)Value(array_t{}).items(); },
+              Throws<NonIterableTypeException>());
+}
+
+TEST(ValueTest, TypeQueries) {
+  EXPECT_TRUE(Value().is_null());
+  EXPECT_TRUE(Value(true).is_boolean());
+  EXPECT_TRUE(Value(1).is_integral());
+  EXPECT_TRUE(Value(1).is_number());
+  EXPECT_TRUE(Value(1.5).is_double());
+  EXPECT_TRUE(Value(1.5).is_number());
+  EXPECT_TRUE(Value("s").is_string());
+  EXPECT_TRUE(Value(array_t{}).is_array());
+  EXPECT_TRUE(Value(object_t{}).is_object());
+  EXPECT_FALSE(Value("s").is_number());
+}
+
+TEST(ValueTest, Find) {
+  Value v = object_t{{"id", 7}};
+
+  const Value* id = std::as_const(v).find("id");
+  ASSERT_THAT(id, ::testing::NotNull());
+  EXPECT_THAT(*id, Eq(7));
+  EXPECT_THAT(v.find("missing"), Eq(nullptr));
+  EXPECT_TRUE(v.contains("id"));
+  EXPECT_FALSE(v.contains("missing"));
+
+  *v.find("id") = 8;
+  EXPECT_THAT(v.at("id"), Eq(8));
+
+  EXPECT_THAT(Value(array_t{}).find("id"), Eq(nullptr));
+  EXPECT_THAT(Value("id").find("id"), Eq(nullptr));
+}
+
+TEST(ValueTest, GetIf) {
+  Value v = "text";
+  ASSERT_THAT(v.get_if<std::string>(), ::testing::NotNull());
+  EXPECT_THAT(*v.get_if<std::string>(), Eq("text"));
+  EXPECT_THAT(v.get_if<bool>(), Eq(nullptr));
+  EXPECT_THAT(v.get_if<double>(), Eq(nullptr));
+  EXPECT_THAT(v.get_if<array_t>(), Eq(nullptr));
+  EXPECT_THAT(v.get_if<object_t>(), Eq(nullptr));
+
+  Value a = array_t{1};
+  a.get_if<array_t>()->push_back(2);
+  EXPECT_THAT(a, Eq(array_t{1, 2}));
+}
+
+TEST(ValueTest, TryGet) {
+  EXPECT_THAT(Value(true).try_get<bool>(), Eq(true));
+  EXPECT_THAT(Value(42).try_get<int32_t>(), Eq(42));
+  EXPECT_THAT(Value(1.5).try_get<double>(), Eq(1.5));
+  EXPECT_THAT(Value(1.5).try_get<float>(), Eq(1.5f));
+  EXPECT_THAT(Value("s").try_get<std::string_view>(), Eq("s"));
+
+  EXPECT_THAT(Value().try_get<bool>(), Eq(std::nullopt));
+  EXPECT_THAT(Value(1.5).try_get<int32_t>(), Eq(std::nullopt));
+  EXPECT_THAT(Value(42).try_get<std::string_view>(), Eq(std::nullopt));
+}
+
+TEST(ValueTest, ValueOr) {
+  Value v = object_t{{"limit", 10}};
+
+  EXPECT_THAT(v.at("limit").value_or(5), Eq(10));
+  EXPECT_THAT(v.at("limit").value_or<std::string_view>("default"),
+              Eq("default"));
+  EXPECT_THAT(Value("x").value_or(false), Eq(false));
+}
+
 TEST(ValueTest, TypeErrorsThrow) {
   Value v = "string";
   EXPECT_THAT([&v]() { (void)v[0]; }, Throws<BadAccessException>());
@@ -225,6 +443,32 @@ TEST(ValueTest, TypeErrorsThrow) {
   EXPECT_THAT([&v]() { v.insert("key", 1); }, Throws<BadAccessException>());
 }
 
+TEST(ValueTest, Raw) {
+  Value v = Raw{"[1, 2]"};
+  EXPECT_THAT(v.is_raw(), Eq(true));
+  EXPECT_THAT(v.is_array(), Eq(false));
+  EXPECT_THAT(v.raw(), Eq("[1, 2]"));
+
+  Value copy = v;
+  EXPECT_THAT(copy, Eq(v));
+  EXPECT_THAT(Value(Raw{"[1,2]"}), Ne(v));
+  EXPECT_THAT(Value(Raw{"\"s\""}), Ne(Value("\"s\"")));
+
+  Value moved = std::move(copy);
+  EXPECT_THAT(moved.raw(), Eq("[1, 2]"));
+
+  EXPECT_THAT([&v]() { (void)v.size(); }, Throws<BadAccessException>());
+  EXPECT_THAT([&v]() { (void)v.begin(); }, Throws<NonIterableTypeException>());
+  EXPECT_THAT([]() { (void)Value(1).raw(); }, Throws<BadAccessException>());
+  EXPECT_THAT(
+      [&v]() {
+        v.visit([] {}, [](bool) {}, [](int32_t) {}, [](double) {},
+                [](const std::string&) {}, [](const array_t&) {},
+                [](const object_t&) {});
+      },
+      Throws<BadAccessException>());
+}
+
 }  // namespace
 
 }  // namespace json